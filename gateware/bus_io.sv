@@ -0,0 +1,54 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Register bus front end, shared by the CIA, VIA and PIA cores.
+//
+// The chip is selected when all chip select inputs are at their active
+// level, given per input by CS_ACTIVE:
+//
+//   CIA: CS                  CS_WIDTH = 1, CS_ACTIVE = 1'b0
+//   VIA: CS1, CS2            CS_WIDTH = 2, CS_ACTIVE = 2'b01
+//   PIA: CS0, CS1, CS2       CS_WIDTH = 3, CS_ACTIVE = 3'b011
+//
+// rd and wr are one-hot register strobes, qualified by chip select and R/W.
+// They are valid throughout the cycle, and are consumed by the cores on the
+// falling edge of PHI2.
+//
+// Read data is driven onto DB0 - DB7 while PHI2 is high. The output enable
+// depends only on PHI2, chip select and R/W, so all personalities share the
+// same PHI2 to DB path.
+module bus_io #(
+    parameter REGS      = 16,
+    parameter CS_WIDTH  = 1,
+    parameter CS_ACTIVE = 1'b0
+) (
+    input  logic                    phi2,
+    input  logic [CS_WIDTH-1:0]     cs,
+    input  logic                    r_w,
+    input  logic [$clog2(REGS)-1:0] rs,
+    input  logic [7:0]              rdata,
+    output logic [7:0]              db_o,
+    output logic                    db_oe,
+    output logic [REGS-1:0]         rd,
+    output logic [REGS-1:0]         wr
+);
+
+    wire sel = cs == CS_ACTIVE;
+
+    always_comb begin
+        rd     = '0;
+        wr     = '0;
+        rd[rs] = sel && r_w;
+        wr[rs] = sel && !r_w;
+    end
+
+    assign db_o  = rdata;
+    assign db_oe = phi2 && sel && r_w;
+
+endmodule
@@ -0,0 +1,350 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6526 Complex Interface Adapter.
+//
+// PHI2 is used directly as the clock; there is no oversampling and no
+// synchronizer on the bus interface. All state is updated on the falling edge
+// of PHI2, which is where the 6526 latches write data and performs read side
+// effects. Read data is a combinational function of RS0 - RS3, and is driven
+// onto DB0 - DB7 while PHI2 is high, so the read access time is a few LUT and
+// I/O delays rather than a fraction of a fast sampling clock.
+//
+// Ports are open drain; the 4.7k pull-ups on the board provide the high
+// level. IRQ, CNT and SP are also open drain.
+//
+// TIMER_MAC16: implement the Timer A and Timer B counters in SB_MAC16 blocks,
+// see cia_timer.sv.
+//
+// OLD_6526: timer and interrupt behaviour of the original 6526, rather than
+// that of the 6526A / 8520 / 8521. IRQ (and ICR bit 7) is asserted one cycle
+// after the interrupt flag is set, rather than together with it, and a Timer
+// B underflow in the cycle of an ICR read does not set ICR bit 1, so that the
+// interrupt is lost (the "Timer B bug"). Only the logic for the selected
+// behaviour is built.
+//
+// The 8521, the HMOS successor of the 6526A on later C64 and C128 boards,
+// has the timer and interrupt timing of the 6526A, so CIA_MODEL=8521 builds
+// the 6526A logic, and the simulation uses the 6526A model for it.
+//
+// Interrupt timing: a timer underflow sets its ICR flag at the falling edge
+// of PHI2 ending the cycle in which the counter reads zero. Reads in the next
+// cycle return the flag, and IRQ is low in that cycle (6526A / 8520 / 8521)
+// or in the cycle after (6526), as on the real chips. The other sources set
+// their flags at the falling edge ending the cycle of the event.
+//
+// ICR read acknowledge: a read of ICR returns the flags as set at the start
+// of the cycle, and clears them at the falling edge of PHI2 ending the read,
+// which also releases IRQ, whatever the sources and the mask. IRQ is thus
+// high in the cycle after the read. An interrupt source in the cycle of the
+// read is not cleared: its flag is set after the clear, and returned by the
+// next read, and IRQ is asserted again at the falling edge one cycle after
+// the read, so that the host sees a new IRQ edge. On the 6526, a source in
+// the cycle before the read is returned by the read, but IRQ and ICR bit 7
+// are not yet set, and are then never set for it. The one exception on the
+// 6526 is the Timer B bug, for which the flag is dropped. This is checked by
+// sim/cia_errata.
+//
+// TOD_BINARY: MOS 8520 TOD, a 24 bit binary event counter, see cia_tod.sv.
+// The TOD filter is then one bit, so that short HSYNC pulses, which the
+// Amiga feeds to the TOD input of the second 8520, are counted.
+//
+// LOW_POWER: hold the TOD input filter while the TOD clock is stopped, and
+// the SP input synchronizer in serial output mode, see cia_tod.sv.
+// All other state only changes on register accesses and timer, CNT, FLAG or
+// serial events.
+//
+// timer_tick enables the PHI2 count source of Timer A and Timer B, and the
+// TOD input filter, in the current cycle. It is tied high for timers counting
+// PHI2 cycles, see redip_timebase.sv for accelerator boards.
+module cia #(
+    parameter TIMER_MAC16 = 0,
+    parameter OLD_6526    = 0,
+    parameter TOD_BINARY  = 0,
+    parameter LOW_POWER   = 0
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       cs_n,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    input  logic [7:0] pa_i,
+    output logic [7:0] pa_o,
+    output logic [7:0] pa_oe,
+    input  logic [7:0] pb_i,
+    output logic [7:0] pb_o,
+    output logic [7:0] pb_oe,
+    output logic       pc_n,
+    input  logic       flag_n,
+    input  logic       tod,
+    input  logic       timer_tick,
+    input  logic       cnt_i,
+    output logic       cnt_oe,
+    input  logic       sp_i,
+    output logic       sp_oe,
+    output logic       irq_n,
+    output logic [1:0] timer_event
+);
+
+    // Register addresses.
+    localparam PRA   = 4'h0;
+    localparam PRB   = 4'h1;
+    localparam DDRA  = 4'h2;
+    localparam DDRB  = 4'h3;
+    localparam TALO  = 4'h4;
+    localparam TAHI  = 4'h5;
+    localparam TBLO  = 4'h6;
+    localparam TBHI  = 4'h7;
+    localparam TOD10 = 4'h8;
+    localparam TODS  = 4'h9;
+    localparam TODM  = 4'hA;
+    localparam TODH  = 4'hB;
+    localparam SDR   = 4'hC;
+    localparam ICR   = 4'hD;
+    localparam CRA   = 4'hE;
+    localparam CRB   = 4'hF;
+
+    // Bus interface.
+    logic [7:0]  rdata;
+    logic [15:0] rd_reg;
+    logic [15:0] wr_reg;
+
+    bus_io #(
+        .REGS      (16),
+        .CS_WIDTH  (1),
+        .CS_ACTIVE (1'b0)
+    ) bus (
+        .phi2  (phi2),
+        .cs    (cs_n),
+        .r_w   (r_w),
+        .rs    (rs),
+        .rdata (rdata),
+        .db_o  (db_o),
+        .db_oe (db_oe),
+        .rd    (rd_reg),
+        .wr    (wr_reg)
+    );
+
+    // Port registers.
+    logic [7:0] pra;
+    logic [7:0] prb;
+    logic [7:0] ddra;
+    logic [7:0] ddrb;
+
+    // Interrupt control.
+    logic [4:0] icr_flags;
+    logic [4:0] icr_mask;
+    logic       ir;
+
+    // Synchronized inputs.
+    logic cnt_s, cnt_q;
+    logic sp_s;
+    logic flag_s, flag_q;
+
+    wire cnt_rise  = cnt_s && !cnt_q;
+    wire flag_fall = !flag_s && flag_q;
+
+    // Timers.
+    logic [15:0] ta;
+    logic [15:0] tb;
+    logic [7:0]  cra;
+    logic [7:0]  crb;
+    logic        ta_underflow;
+    logic        tb_underflow;
+    logic        ta_pb;
+    logic        tb_pb;
+    logic        tb_src;
+
+    always_comb begin
+        case (crb[6:5])
+            2'b00: tb_src = timer_tick;
+            2'b01: tb_src = cnt_rise;
+            2'b10: tb_src = ta_underflow;
+            2'b11: tb_src = ta_underflow && cnt_s;
+        endcase
+    end
+
+    cia_timer #(
+        .MAC16 (TIMER_MAC16)
+    ) timer_a (
+        .phi2      (phi2),
+        .res_n     (res_n),
+        .wr_lo     (wr_reg[TALO]),
+        .wr_hi     (wr_reg[TAHI]),
+        .wr_cr     (wr_reg[CRA]),
+        .data      (db_i),
+        .count_src (cra[5] ? cnt_rise : timer_tick),
+        .counter   (ta),
+        .cr        (cra),
+        .underflow (ta_underflow),
+        .pb        (ta_pb)
+    );
+
+    cia_timer #(
+        .MAC16 (TIMER_MAC16)
+    ) timer_b (
+        .phi2      (phi2),
+        .res_n     (res_n),
+        .wr_lo     (wr_reg[TBLO]),
+        .wr_hi     (wr_reg[TBHI]),
+        .wr_cr     (wr_reg[CRB]),
+        .data      (db_i),
+        .count_src (tb_src),
+        .counter   (tb),
+        .cr        (crb),
+        .underflow (tb_underflow),
+        .pb        (tb_pb)
+    );
+
+    // Time of day.
+    logic [3:0][7:0] tod_rdata;
+    logic            tod_alarm;
+
+    cia_tod #(
+        .FILTER    (TOD_BINARY ? 1 : 4),
+        .BINARY    (TOD_BINARY),
+        .LOW_POWER (LOW_POWER)
+    ) tod_clock (
+        .phi2      (phi2),
+        .res_n     (res_n),
+        .tod       (tod),
+        .sample    (timer_tick),
+        .todin     (cra[7]),
+        .alarm_sel (crb[7]),
+        .wr        (wr_reg[TODH:TOD10]),
+        .rd        (rd_reg[TODH:TOD10]),
+        .data      (db_i),
+        .rdata     (tod_rdata),
+        .alarm     (tod_alarm)
+    );
+
+    // Serial data register.
+    logic [7:0] sdr;
+    logic       sdr_irq;
+    logic       cnt_o;
+    logic       sp_o;
+
+    cia_sdr serial (
+        .phi2         (phi2),
+        .res_n        (res_n),
+        .spmode       (cra[6]),
+        .wr           (wr_reg[SDR]),
+        .data         (db_i),
+        .ta_underflow (ta_underflow),
+        .cnt_rise     (cnt_rise),
+        .sp_i         (sp_s),
+        .sdr          (sdr),
+        .cnt_o        (cnt_o),
+        .sp_o         (sp_o),
+        .irq          (sdr_irq)
+    );
+
+    assign cnt_oe = !cnt_o;
+    assign sp_oe  = !sp_o;
+
+    // Ports. PB6 and PB7 are overridden by the timer outputs when enabled.
+    logic [7:0] pb_out;
+    logic [7:0] pb_dir;
+
+    always_comb begin
+        pb_out = prb;
+        pb_dir = ddrb;
+        if (cra[1]) begin
+            pb_out[6] = ta_pb;
+            pb_dir[6] = 1'b1;
+        end
+        if (crb[1]) begin
+            pb_out[7] = tb_pb;
+            pb_dir[7] = 1'b1;
+        end
+    end
+
+    assign pa_o  = pra;
+    assign pa_oe = ddra & ~pra;
+    assign pb_o  = pb_out;
+    assign pb_oe = pb_dir & ~pb_out;
+
+    // Read data.
+    always_comb begin
+        case (rs)
+            PRA:   rdata = pa_i;
+            PRB:   rdata = pb_i;
+            DDRA:  rdata = ddra;
+            DDRB:  rdata = ddrb;
+            TALO:  rdata = ta[7:0];
+            TAHI:  rdata = ta[15:8];
+            TBLO:  rdata = tb[7:0];
+            TBHI:  rdata = tb[15:8];
+            TOD10: rdata = tod_rdata[0];
+            TODS:  rdata = tod_rdata[1];
+            TODM:  rdata = tod_rdata[2];
+            TODH:  rdata = tod_rdata[3];
+            SDR:   rdata = sdr;
+            ICR:   rdata = { ir, 2'b00, icr_flags };
+            CRA:   rdata = cra;
+            CRB:   rdata = crb;
+        endcase
+    end
+
+    assign irq_n = !ir;
+
+    // ICR read acknowledge, and the interrupt sources of this cycle, see
+    // above.
+    wire       icr_ack = rd_reg[ICR];
+    wire [4:0] icr_src = { flag_fall, sdr_irq, tod_alarm,
+                           tb_underflow && !(OLD_6526 && icr_ack), ta_underflow };
+    wire [4:0] icr_next = (icr_ack ? 5'h00 : icr_flags) | icr_src;
+
+    // Timer underflow strobes, for instrumentation, see redip_perf.sv.
+    assign timer_event = { tb_underflow, ta_underflow };
+
+    always_ff @(negedge phi2) begin
+        cnt_s  <= cnt_i;
+        cnt_q  <= cnt_s;
+        if (!cra[6] || !LOW_POWER) sp_s <= sp_i;
+        flag_s <= flag_n;
+        flag_q <= flag_s;
+
+        if (!res_n) begin
+            pra        <= 8'h00;
+            prb        <= 8'h00;
+            ddra       <= 8'h00;
+            ddrb       <= 8'h00;
+            icr_flags  <= 5'h00;
+            icr_mask   <= 5'h00;
+            ir         <= 1'b0;
+            pc_n       <= 1'b1;
+        end else begin
+            if (wr_reg[PRA])  pra  <= db_i;
+            if (wr_reg[PRB])  prb  <= db_i;
+            if (wr_reg[DDRA]) ddra <= db_i;
+            if (wr_reg[DDRB]) ddrb <= db_i;
+
+            // PC is pulled low for one cycle following a read or write of PRB.
+            pc_n <= !(rd_reg[PRB] || wr_reg[PRB]);
+
+            // Interrupt sources in the cycle of an ICR read are set after
+            // the acknowledge, except for Timer B on the old 6526.
+            icr_flags <= icr_next;
+
+            if (wr_reg[ICR]) begin
+                icr_mask <= db_i[7] ? icr_mask | db_i[4:0] : icr_mask & ~db_i[4:0];
+            end
+
+            // IRQ is asserted together with the interrupt flag, or one cycle
+            // later on the old 6526. The acknowledge overrides any source, so
+            // IRQ is always released after an ICR read.
+            ir <= !icr_ack && (ir || |((OLD_6526 ? icr_flags : icr_next) & icr_mask));
+        end
+    end
+
+endmodule
@@ -0,0 +1,113 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6526 serial data register.
+//
+// Input mode (CRA bit 6 = 0): SP is shifted in on rising CNT edges, MSB
+// first. The serial data register is loaded after eight bits.
+//
+// Output mode (CRA bit 6 = 1): a write to the serial data register starts
+// shifting on the next Timer A underflow. CNT toggles on each underflow, with
+// SP changing on the falling edge, for a bit rate of half the underflow rate.
+//
+// The serial data register is transferred to the shift register on the
+// falling CNT edge of the first bit. A byte written before the rising CNT edge
+// of the last bit of the current byte follows without a gap, so that a byte
+// takes 16 Timer A periods, down to 16 cycles at the maximum rate of one
+// underflow per cycle (Timer A latch 0). irq is high in the cycle following
+// the rising CNT edge of the last bit in output mode, and in the cycle
+// following cnt_rise for the last bit in input mode. sim/sdr_speed.cpp checks
+// this timing on the pins at Timer A latch 0 and 1.
+module cia_sdr (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       spmode,
+    input  logic       wr,
+    input  logic [7:0] data,
+    input  logic       ta_underflow,
+    input  logic       cnt_rise,
+    input  logic       sp_i,
+    output logic [7:0] sdr,
+    output logic       cnt_o,
+    output logic       sp_o,
+    output logic       irq
+);
+
+    logic [7:0] shift;
+    logic [2:0] bitcnt;
+    logic       pending;
+    logic       active;
+
+    // Last bit of a byte shifted in or out.
+    wire in_done  = !spmode && cnt_rise && bitcnt == 3'd7;
+    wire out_done = spmode && active && ta_underflow && !cnt_o && bitcnt == 3'd7;
+
+    always_ff @(negedge phi2) begin
+        if (!res_n) begin
+            sdr     <= 8'h00;
+            shift   <= 8'h00;
+            bitcnt  <= 3'd0;
+            pending <= 1'b0;
+            active  <= 1'b0;
+            cnt_o   <= 1'b1;
+            sp_o    <= 1'b1;
+            irq     <= 1'b0;
+        end else begin
+            irq <= in_done || out_done;
+
+            if (!spmode) begin
+                active <= 1'b0;
+                cnt_o  <= 1'b1;
+                sp_o   <= 1'b1;
+
+                if (cnt_rise) begin
+                    shift  <= { shift[6:0], sp_i };
+                    bitcnt <= bitcnt + 3'd1;
+                end
+
+                if (in_done) begin
+                    sdr <= { shift[6:0], sp_i };
+                end
+            end else if (ta_underflow && (active || pending)) begin
+                if (cnt_o) begin
+                    // Falling CNT edge: present the next bit.
+                    if (!active) begin
+                        shift   <= sdr;
+                        sp_o    <= sdr[7];
+                        pending <= 1'b0;
+                        active  <= 1'b1;
+                        bitcnt  <= 3'd0;
+                    end else begin
+                        sp_o <= shift[7];
+                    end
+                    cnt_o <= 1'b0;
+                end else begin
+                    // Rising CNT edge: the receiver samples SP.
+                    cnt_o  <= 1'b1;
+                    shift  <= { shift[6:0], 1'b0 };
+                    bitcnt <= bitcnt + 3'd1;
+                    if (out_done) begin
+                        active <= pending;
+                        if (pending) begin
+                            shift   <= sdr;
+                            pending <= 1'b0;
+                            bitcnt  <= 3'd0;
+                        end
+                    end
+                end
+            end
+
+            if (wr) begin
+                sdr <= data;
+                if (spmode) pending <= 1'b1;
+            end
+        end
+    end
+
+endmodule
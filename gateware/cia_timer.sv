@@ -0,0 +1,110 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6526 interval timer (Timer A or Timer B).
+//
+// The timer is clocked on the falling edge of PHI2, like all other CIA state.
+// count_src is the selected count source for the current cycle (PHI2, CNT
+// edges, or Timer A underflows); the caller decodes this from the control
+// register bits which are specific to each timer.
+//
+// MAC16: implement the counter in an SB_MAC16, see timer_counter.sv.
+module cia_timer #(
+    parameter MAC16 = 0
+) (
+    input  logic        phi2,
+    input  logic        res_n,
+    input  logic        wr_lo,
+    input  logic        wr_hi,
+    input  logic        wr_cr,
+    input  logic [7:0]  data,
+    input  logic        count_src,
+    output logic [15:0] counter,
+    output logic [7:0]  cr,
+    output logic        underflow,
+    output logic        pb
+);
+
+    logic [15:0] latch;
+    logic [15:0] latch_next;
+    logic        count_q;
+    logic        load_q;
+    logic        toggle;
+    logic        pulse;
+    logic        zero;
+
+    // Control register bits.
+    wire start   = cr[0];
+    wire outmode = cr[2];
+    wire runmode = cr[3];
+
+    always_comb begin
+        latch_next = latch;
+        if (wr_lo) latch_next[7:0]  = data;
+        if (wr_hi) latch_next[15:8] = data;
+    end
+
+    // The counter underflows when it is decremented from zero; a latch
+    // value of N thus gives a period of N + 1 counts.
+    assign underflow = count_q && zero;
+
+    // The latch is transferred to the counter on underflow, on force load,
+    // and on a write to the high byte while the timer is stopped.
+    wire        reload       = !res_n || underflow || load_q || (wr_hi && !start);
+    wire [15:0] reload_value = res_n ? latch_next : 16'hFFFF;
+
+    timer_counter #(
+        .MAC16 (MAC16)
+    ) timer (
+        .phi2    (phi2),
+        .load    (reload),
+        .value   (reload_value),
+        .count   (count_q),
+        .counter (counter),
+        .zero    (zero)
+    );
+
+    // PB6/PB7 output: one cycle pulse or toggle on underflow.
+    assign pb = outmode ? toggle : pulse;
+
+    always_ff @(negedge phi2) begin
+        if (!res_n) begin
+            latch   <= 16'hFFFF;
+            cr      <= 8'h00;
+            count_q <= 1'b0;
+            load_q  <= 1'b0;
+            toggle  <= 1'b0;
+            pulse   <= 1'b0;
+        end else begin
+            latch <= latch_next;
+
+            // LOAD is a strobe, and always reads back as zero.
+            if (wr_cr) begin
+                cr <= { data[7:5], 1'b0, data[3:0] };
+            end else if (underflow && runmode) begin
+                cr[0] <= 1'b0;
+            end
+
+            // Count pipeline: a count source seen in one cycle decrements
+            // the counter at the end of the next cycle.
+            count_q <= start && count_src && !(underflow && runmode);
+            load_q  <= wr_cr && data[4];
+
+            // The toggle output goes high whenever the timer is started.
+            if (wr_cr && data[0] && !start) begin
+                toggle <= 1'b1;
+            end else if (underflow) begin
+                toggle <= !toggle;
+            end
+
+            pulse <= underflow;
+        end
+    end
+
+endmodule
@@ -0,0 +1,240 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6526 Time Of Day clock and alarm, or MOS 8520 event counter.
+//
+// Registers 8 - B hold tenths of seconds, seconds, minutes and hours in BCD,
+// the hours register having AM/PM in bit 7.
+//
+// Reading the hours register latches all four registers until the tenths
+// register is read. Writing the hours register stops the clock until the
+// tenths register is written. With CRB bit 7 set, writes go to the alarm.
+//
+// BINARY: 8520 event counter. Registers 8 - A hold a 24 bit binary counter,
+// LSB first, which counts every rising TOD edge without the 50/60Hz
+// prescaler; register B reads zero. Reading register A (MSB) latches the
+// counter until register 8 (LSB) is read, and writing register A stops the
+// counter until register 8 is written. The alarm compares all 24 bits. The
+// BCD logic is not built, so the counter costs one 24 bit carry chain.
+//
+// The TOD input is sampled on the falling edge of PHI2 only, so no fast
+// sampling clock is needed. Mains derived TOD signals are filtered by an
+// up/down integrator of FILTER bits: the filtered level only changes after
+// the input has been high (or low) for 2**FILTER - 1 more PHI2 cycles than
+// the opposite level, which rejects spikes and ringing on slow edges. With the
+// default of 4 bits this is 15us at 1MHz, far below a 50/60Hz half period.
+// The filter only samples in cycles with sample set, so that its time
+// constant follows the timer clock rather than PHI2.
+//
+// LOW_POWER: hold the filter while the clock is stopped, so that the TOD input
+// does not toggle any flip-flops. The filter then settles within 2**FILTER - 1
+// cycles after the clock is started, which may shift the first tenth of a
+// second by one TOD period.
+module cia_tod #(
+    parameter FILTER    = 4,
+    parameter BINARY    = 0,
+    parameter LOW_POWER = 0
+) (
+    input  logic            phi2,
+    input  logic            res_n,
+    input  logic            tod,
+    input  logic            sample,     // Filter sample enable
+    input  logic            todin,      // CRA bit 7: 1 = 50Hz, 0 = 60Hz
+    input  logic            alarm_sel,  // CRB bit 7: 1 = write alarm
+    input  logic [3:0]      wr,         // Write strobes for registers 8 - B
+    input  logic [3:0]      rd,         // Read strobes for registers 8 - B
+    input  logic [7:0]      data,
+    output logic [3:0][7:0] rdata,
+    output logic            alarm
+);
+
+    // Time of day, packed as { pm, hr[4:0], min[6:0], sec[6:0], ths[3:0] },
+    // or the binary event count.
+    logic [23:0] time_q;
+    logic [23:0] time_l;
+    logic [23:0] alarm_q;
+    logic [23:0] time_inc;
+    logic        running;
+    logic        latched;
+    logic        match_q;
+    logic [2:0]  prescaler;
+    logic        tod_s;
+    logic        tod_f;
+
+    // TOD glitch filter.
+    localparam [FILTER-1:0] FILTER_MAX = {FILTER{1'b1}};
+
+    logic [FILTER-1:0] tod_count;
+
+    wire filter_en = sample && (running || !LOW_POWER);
+
+    always_ff @(negedge phi2) begin
+        if (filter_en) begin
+            tod_s <= tod;
+
+            if (tod_s && tod_count != FILTER_MAX) begin
+                tod_count <= tod_count + 1'b1;
+            end else if (!tod_s && tod_count != 0) begin
+                tod_count <= tod_count - 1'b1;
+            end
+
+            if (tod_count == FILTER_MAX) begin
+                tod_f <= 1'b1;
+            end else if (tod_count == 0) begin
+                tod_f <= 1'b0;
+            end
+        end
+    end
+
+    // 50/60Hz filtered input edge, and tenths of seconds tick. The edge is
+    // only taken in a sample cycle, where tod_f follows it, so that it lasts
+    // one cycle also when sample is not set in every cycle.
+    wire       tod_edge = filter_en && tod_count == FILTER_MAX && !tod_f;
+    wire [2:0] tod_div  = todin ? 3'd4 : 3'd5;
+    wire       tick     = running && tod_edge && (BINARY || prescaler == tod_div);
+
+    // Register holding the latch and stop controls: hours, or counter MSB.
+    localparam MSB = BINARY ? 2 : 3;
+
+    // BCD increment of a two digit value, wrapping to zero at max.
+    function automatic logic [6:0] bcd_inc(input logic [6:0] v, input logic [6:0] max);
+        if (v == max) begin
+            bcd_inc = 7'h00;
+        end else if (v[3:0] == 4'h9) begin
+            bcd_inc = { v[6:4] + 3'd1, 4'h0 };
+        end else begin
+            bcd_inc = { v[6:4], v[3:0] + 4'd1 };
+        end
+    endfunction
+
+    // Next time of day, with carries from tenths through hours, or the next
+    // event count.
+    always_comb begin
+        logic       pm;
+        logic [4:0] hr;
+        logic [6:0] min;
+        logic [6:0] sec;
+        logic [3:0] ths;
+
+        { pm, hr, min, sec, ths } = time_q;
+
+        if (ths != 4'h9) begin
+            ths = ths + 4'd1;
+        end else begin
+            ths = 4'h0;
+            if (sec != 7'h59) begin
+                sec = bcd_inc(sec, 7'h59);
+            end else begin
+                sec = 7'h00;
+                if (min != 7'h59) begin
+                    min = bcd_inc(min, 7'h59);
+                end else begin
+                    min = 7'h00;
+                    // 11 -> 12 toggles AM/PM, 12 -> 1.
+                    if (hr == 5'h11) begin
+                        hr = 5'h12;
+                        pm = !pm;
+                    end else if (hr == 5'h12) begin
+                        hr = 5'h01;
+                    end else if (hr[3:0] == 4'h9) begin
+                        hr = 5'h10;
+                    end else begin
+                        hr = { hr[4], hr[3:0] + 4'd1 };
+                    end
+                end
+            end
+        end
+
+        time_inc = BINARY ? time_q + 24'd1 : { pm, hr, min, sec, ths };
+    end
+
+    always_comb begin
+        logic [23:0] t;
+
+        t = latched ? time_l : time_q;
+        if (BINARY) begin
+            rdata[0] = t[7:0];
+            rdata[1] = t[15:8];
+            rdata[2] = t[23:16];
+            rdata[3] = 8'h00;
+        end else begin
+            rdata[0] = { 4'h0, t[3:0] };
+            rdata[1] = { 1'b0, t[10:4] };
+            rdata[2] = { 1'b0, t[17:11] };
+            rdata[3] = { t[23], 2'b00, t[22:18] };
+        end
+    end
+
+    // The alarm interrupt is raised when time of day becomes equal to alarm.
+    wire match = time_q == alarm_q;
+    assign alarm = match && !match_q;
+
+    always_ff @(negedge phi2) begin
+        if (!res_n) begin
+            time_q    <= BINARY ? 24'h0 : { 1'b0, 5'h01, 18'h0 };
+            time_l    <= 24'h0;
+            alarm_q   <= 24'h0;
+            running   <= 1'b0;
+            latched   <= 1'b0;
+            match_q   <= 1'b0;
+            prescaler <= 3'd0;
+        end else begin
+            match_q <= match;
+
+            if (tod_edge) begin
+                prescaler <= (prescaler == tod_div) ? 3'd0 : prescaler + 3'd1;
+            end
+
+            if (tick) begin
+                time_q <= time_inc;
+            end
+
+            // Register writes override the tick.
+            if (BINARY) begin
+                if (alarm_sel) begin
+                    if (wr[0]) alarm_q[7:0]   <= data;
+                    if (wr[1]) alarm_q[15:8]  <= data;
+                    if (wr[2]) alarm_q[23:16] <= data;
+                end else begin
+                    if (wr[0]) time_q[7:0]   <= data;
+                    if (wr[1]) time_q[15:8]  <= data;
+                    if (wr[2]) time_q[23:16] <= data;
+                end
+            end else if (alarm_sel) begin
+                if (wr[0]) alarm_q[3:0]   <= data[3:0];
+                if (wr[1]) alarm_q[10:4]  <= data[6:0];
+                if (wr[2]) alarm_q[17:11] <= data[6:0];
+                if (wr[3]) alarm_q[23:18] <= { data[7], data[4:0] };
+            end else begin
+                if (wr[0]) time_q[3:0]   <= data[3:0];
+                if (wr[1]) time_q[10:4]  <= data[6:0];
+                if (wr[2]) time_q[17:11] <= data[6:0];
+                if (wr[3]) time_q[23:18] <= { data[7], data[4:0] };
+            end
+
+            if (!alarm_sel) begin
+                if (wr[MSB]) begin
+                    running <= 1'b0;
+                end else if (wr[0]) begin
+                    running   <= 1'b1;
+                    prescaler <= 3'd0;
+                end
+            end
+
+            // Read latch.
+            if (rd[MSB] && !latched) begin
+                time_l  <= time_q;
+                latched <= 1'b1;
+            end else if (rd[0]) begin
+                latched <= 1'b0;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+# This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+# MOS 6526/8520/8521 CIA FPGA replacement.
+#
+# Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+# ----------------------------------------------------------------------------
+
+"""Set the configuration clock frequency range of an iCE40 bitstream.
+
+usage: freqrange.py <low|medium|high> <file.bin>
+
+The frequency range is set by command 0x51 following the preamble, and
+selects the internal oscillator setting used for SPI_SCLK while the FPGA
+loads its configuration from flash. icepack always writes "low". The command
+precedes the first CRC reset, so it can be patched without recomputing the
+CRC.
+"""
+
+import sys
+
+PREAMBLE = b"\x7e\xaa\x99\x7e"
+FREQRANGE = {"low": 0x00, "medium": 0x01, "high": 0x02}
+
+
+def set_freqrange(bits, freq, offset=0):
+    """Patch the bitstream image starting at offset, returning the offset."""
+    i = bits.find(PREAMBLE, offset)
+    if i < 0:
+        raise ValueError("no preamble found")
+    i += len(PREAMBLE)
+    if bits[i] != 0x51:
+        raise ValueError(f"expected frequency range command at {i:#x}, got {bits[i]:#04x}")
+    bits[i + 1] = FREQRANGE[freq]
+    return i + 2
+
+
+def main(argv):
+    if len(argv) != 3 or argv[1] not in FREQRANGE:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 2
+
+    with open(argv[2], "rb") as f:
+        bits = bytearray(f.read())
+
+    try:
+        set_freqrange(bits, argv[1])
+    except ValueError as e:
+        print(f"{argv[2]}: {e}", file=sys.stderr)
+        return 1
+
+    with open(argv[2], "wb") as f:
+        f.write(bits)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,206 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6520 Peripheral Interface Adapter.
+//
+// As for the CIA and VIA, PHI2 is used directly as the clock, register state
+// is updated on the falling edge of PHI2, and read data is a combinational
+// function of RS0 - RS1 driven while PHI2 is high.
+//
+// CA1, CA2, CB1 and CB2 are sampled on the rising edge of PHI2 and acted on
+// at the following falling edge, see via.sv. IRQA and IRQB are separate open
+// drain outputs, each a combinational function of the control register
+// flags and enables, so they are released directly after the falling edge of
+// PHI2 ending the port read which clears the flags.
+//
+// Port A is open drain like the NMOS 6520 passive pull-up outputs, with the
+// 4.7k pull-ups on the board providing the high level. Port B, CA2 and CB2 are
+// push-pull when outputs.
+module pia (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       cs0,
+    input  logic       cs1,
+    input  logic       cs2_n,
+    input  logic       r_w,
+    input  logic [1:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    input  logic [7:0] pa_i,
+    output logic [7:0] pa_o,
+    output logic [7:0] pa_oe,
+    input  logic [7:0] pb_i,
+    output logic [7:0] pb_o,
+    output logic [7:0] pb_oe,
+    input  logic       ca1,
+    input  logic       ca2_i,
+    output logic       ca2_o,
+    output logic       ca2_oe,
+    input  logic       cb1,
+    input  logic       cb2_i,
+    output logic       cb2_o,
+    output logic       cb2_oe,
+    output logic       irqa_n,
+    output logic       irqb_n
+);
+
+    // Register addresses.
+    localparam PA  = 2'h0;
+    localparam CRA = 2'h1;
+    localparam PB  = 2'h2;
+    localparam CRB = 2'h3;
+
+    // Bus interface.
+    logic [7:0] rdata;
+    logic [3:0] rd_reg;
+    logic [3:0] wr_reg;
+
+    bus_io #(
+        .REGS      (4),
+        .CS_WIDTH  (3),
+        .CS_ACTIVE (3'b011)
+    ) bus (
+        .phi2  (phi2),
+        .cs    ({ cs2_n, cs1, cs0 }),
+        .r_w   (r_w),
+        .rs    (rs),
+        .rdata (rdata),
+        .db_o  (db_o),
+        .db_oe (db_oe),
+        .rd    (rd_reg),
+        .wr    (wr_reg)
+    );
+
+    // Registers. Control register bits 7 and 6 are the IRQ1 and IRQ2 flags,
+    // and are held separately.
+    logic [7:0] pra;
+    logic [7:0] prb;
+    logic [7:0] ddra;
+    logic [7:0] ddrb;
+    logic [5:0] cra;
+    logic [5:0] crb;
+    logic [1:0] irqa;
+    logic [1:0] irqb;
+
+    // Peripheral or data direction register access, selected by bit 2.
+    wire pra_rd = rd_reg[PA] && cra[2];
+    wire prb_rd = rd_reg[PB] && crb[2];
+    wire prb_wr = wr_reg[PB] && crb[2];
+
+    // Control lines, sampled on the rising edge of PHI2, and the values seen
+    // at the previous falling edge.
+    logic ca1_s, ca2_s, cb1_s, cb2_s;
+    logic ca1_q, ca2_q, cb1_q, cb2_q;
+
+    always_ff @(posedge phi2) begin
+        ca1_s <= ca1;
+        ca2_s <= ca2_i;
+        cb1_s <= cb1;
+        cb2_s <= cb2_i;
+    end
+
+    // Active edges: bit 1 for C1, bit 4 for C2 in input mode (bit 5 = 0).
+    wire ca1_edge = cra[1] ? ca1_s && !ca1_q : !ca1_s && ca1_q;
+    wire ca2_edge = !cra[5] && (cra[4] ? ca2_s && !ca2_q : !ca2_s && ca2_q);
+    wire cb1_edge = crb[1] ? cb1_s && !cb1_q : !cb1_s && cb1_q;
+    wire cb2_edge = !crb[5] && (crb[4] ? cb2_s && !cb2_q : !cb2_s && cb2_q);
+
+    // CA2 and CB2 outputs: handshake (bits 4 - 3 = 00), pulse (01), or the
+    // level of bit 3 (1x).
+    logic ca2_hs;
+    logic cb2_hs;
+    logic prb_written;
+    logic cb1_event;
+
+    assign ca2_o  = cra[4] ? cra[3] : ca2_hs;
+    assign ca2_oe = cra[5];
+    assign cb2_o  = crb[4] ? crb[3] : cb2_hs;
+    assign cb2_oe = crb[5];
+
+    // Ports.
+    assign pa_o  = pra;
+    assign pa_oe = ddra & ~pra;
+    assign pb_o  = prb;
+    assign pb_oe = ddrb;
+
+    // Read data. Port B reads output bits from the output register.
+    always_comb begin
+        case (rs)
+            PA:  rdata = cra[2] ? pa_i : ddra;
+            CRA: rdata = { irqa, cra };
+            PB:  rdata = crb[2] ? (ddrb & prb) | (~ddrb & pb_i) : ddrb;
+            CRB: rdata = { irqb, crb };
+        endcase
+    end
+
+    assign irqa_n = !(irqa[1] && cra[0] || irqa[0] && cra[3] && !cra[5]);
+    assign irqb_n = !(irqb[1] && crb[0] || irqb[0] && crb[3] && !crb[5]);
+
+    always_ff @(negedge phi2) begin
+        ca1_q <= ca1_s;
+        ca2_q <= ca2_s;
+        cb1_q <= cb1_s;
+        cb2_q <= cb2_s;
+
+        if (!res_n) begin
+            pra         <= 8'h00;
+            prb         <= 8'h00;
+            ddra        <= 8'h00;
+            ddrb        <= 8'h00;
+            cra         <= 6'h00;
+            crb         <= 6'h00;
+            irqa        <= 2'b00;
+            irqb        <= 2'b00;
+            ca2_hs      <= 1'b1;
+            prb_written <= 1'b0;
+            cb1_event   <= 1'b0;
+        end else begin
+            if (wr_reg[PA]) begin
+                if (cra[2]) pra <= db_i; else ddra <= db_i;
+            end
+            if (wr_reg[PB]) begin
+                if (crb[2]) prb <= db_i; else ddrb <= db_i;
+            end
+            if (wr_reg[CRA]) cra <= db_i[5:0];
+            if (wr_reg[CRB]) crb <= db_i[5:0];
+
+            // Flags are cleared by reading the peripheral register, but are
+            // set by an edge in the same cycle.
+            irqa <= (pra_rd ? 2'b00 : irqa) | { ca1_edge, ca2_edge };
+            irqb <= (prb_rd ? 2'b00 : irqb) | { cb1_edge, cb2_edge };
+
+            // CA2 goes low on the falling edge of PHI2 ending a read of port
+            // A, and returns high after one cycle (pulse) or on the active
+            // CA1 edge (handshake).
+            if (pra_rd) begin
+                ca2_hs <= 1'b0;
+            end else if (cra[3] || ca1_edge) begin
+                ca2_hs <= 1'b1;
+            end
+
+            prb_written <= prb_wr;
+            cb1_event   <= cb1_edge;
+        end
+    end
+
+    // CB2 goes low on the rising edge of PHI2 following a write of port B,
+    // and returns high on the next rising edge (pulse) or after the active
+    // CB1 edge (handshake).
+    always_ff @(posedge phi2) begin
+        if (!res_n) begin
+            cb2_hs <= 1'b1;
+        end else if (prb_written) begin
+            cb2_hs <= 1'b0;
+        end else if (crb[3] || cb1_event) begin
+            cb2_hs <= 1'b1;
+        end
+    end
+
+endmodule
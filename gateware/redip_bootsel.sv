@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Multiboot personality selector, see redip-bootsel.pcf.
+//
+// This is image 0 of the multiboot flash image, and selects the personality
+// image by warmboot. The setting is one byte at SETTING_ADDR in the flash:
+//
+//   1: CIA, 2: VIA, 3: PIA
+//
+// Any other value, e.g. erased flash, or a value above IMAGES (the number of
+// personality images in the flash image), selects the CIA.
+//
+// The flash is woken from deep power-down (ABh), and the setting is read
+// (03h), using the internal 48MHz oscillator divided by 4. SPI_SCK and
+// SPI_SO are only driven while SPI_SS is low, since they are PB7 and PC on the
+// DIP header whenever the flash is deselected. No bus pins are used, so the
+// host sees an undriven chip until the personality image has been loaded.
+module redip_bootsel #(
+    parameter SETTING_ADDR = 24'h0FF000,
+    parameter IMAGES       = 3
+) (
+    output wire SPI_SS,
+    output wire SPI_SCK,
+    output wire SPI_SO,
+    input  wire SPI_SI
+);
+
+    localparam [23:0] ADDR = SETTING_ADDR;
+
+    logic clk;
+
+    SB_HFOSC #(
+        .CLKHF_DIV ("0b10")
+    ) osc (
+        .CLKHFPU (1'b1),
+        .CLKHFEN (1'b1),
+        .CLKHF   (clk)
+    );
+
+    // All flip-flops are cleared by configuration.
+    logic [10:0] delay;
+    logic [1:0]  step;
+    logic        busy;
+    logic [5:0]  nbits;
+    logic [39:0] tx;
+    logic [7:0]  rx;
+    logic        sck;
+    logic        boot;
+
+    // Each step is preceded by 2048 oscillator cycles (~170us), which covers
+    // both oscillator start-up and the flash wake-up time.
+    always_ff @(posedge clk) begin
+        if (busy) begin
+            // SPI mode 0, sampling SPI_SI at the end of the SCK high phase.
+            sck <= !sck;
+            if (sck) begin
+                rx    <= { rx[6:0], SPI_SI };
+                tx    <= { tx[38:0], 1'b0 };
+                nbits <= nbits - 1'b1;
+                busy  <= nbits != 6'd1;
+            end
+        end else begin
+            delay <= delay + 1'b1;
+            if (&delay) begin
+                case (step)
+                    2'd0: begin
+                        tx    <= { 8'hAB, 32'h0 };
+                        nbits <= 6'd8;
+                        busy  <= 1'b1;
+                    end
+                    2'd1: begin
+                        tx    <= { 8'h03, ADDR, 8'h00 };
+                        nbits <= 6'd40;
+                        busy  <= 1'b1;
+                    end
+                    default: begin
+                        boot <= 1'b1;
+                    end
+                endcase
+                if (step != 2'd3) step <= step + 1'b1;
+            end
+        end
+    end
+
+    wire [1:0] image = (rx >= 8'd1 && rx <= IMAGES) ? rx[1:0] : 2'd1;
+
+    SB_WARMBOOT warmboot (
+        .BOOT (boot),
+        .S1   (image[1]),
+        .S0   (image[0])
+    );
+
+    assign SPI_SS  = busy ? 1'b0 : 1'bz;
+    assign SPI_SCK = busy ? sck : 1'bz;
+    assign SPI_SO  = busy ? tx[39] : 1'bz;
+
+endmodule
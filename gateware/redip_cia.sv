@@ -0,0 +1,332 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Top level for MOS 6526 / 8520 / 8521 CIA, see redip-cia.pcf.
+//
+// RES_HOLD: number of PHI2 cycles to hold RES low after configuration, see
+// redip_reset.sv.
+//
+// PHI2_INV: the PHI2 pad carries inverted PHI2, see redip_phi2.sv.
+//
+// PHI2_GBIN: PHI2 is on a global buffer input pad, see redip_phi2.sv.
+//
+// TIMER_MAC16: implement the timers in SB_MAC16 blocks, see cia_timer.sv.
+//
+// OLD_6526: original 6526 timer and interrupt behaviour, see cia.sv.
+//
+// TOD_BINARY: MOS 8520 TOD event counter, see cia.sv.
+//
+// LOW_POWER: hold unused input logic, see cia.sv.
+//
+// TIMER_SOURCE, TIMER_HZ: timer clock for accelerator boards, see
+// redip_timebase.sv.
+//
+// FLASH_UPDATE: in-system flash update over the host bus, see
+// redip_flash.sv.
+//
+// PERF_COUNTERS: performance counters in a hidden register window, see
+// redip_perf.sv.
+//
+// LOGIC_ANALYZER: bus logic analyzer with LA_DEPTH samples in EBR, see
+// redip_la.sv.
+//
+// PORT_PIPE: PA / PB burst transfers through EBR FIFOs, with the PC / FLAG
+// handshake in gateware, see redip_pipe.sv.
+module redip_cia #(
+    parameter RES_HOLD       = 0,
+    parameter PHI2_INV       = 0,
+    parameter PHI2_GBIN      = 0,
+    parameter TIMER_MAC16    = 0,
+    parameter OLD_6526       = 0,
+    parameter TOD_BINARY     = 0,
+    parameter LOW_POWER      = 0,
+    parameter TIMER_SOURCE   = 0,
+    parameter TIMER_HZ       = 985248,
+    parameter FLASH_UPDATE   = 0,
+    parameter PERF_COUNTERS  = 0,
+    parameter LOGIC_ANALYZER = 0,
+    parameter LA_DEPTH       = 512,
+    parameter PORT_PIPE      = 0
+) (
+    inout  wire PA0,
+    inout  wire PA1,
+    inout  wire PA2,
+    inout  wire PA3,
+    inout  wire PA4,
+    inout  wire PA5,
+    inout  wire PA6,
+    inout  wire PA7,
+    inout  wire PB0,
+    inout  wire PB1,
+    inout  wire PB2,
+    inout  wire PB3,
+    inout  wire PB4,
+    inout  wire PB5,
+    inout  wire PB6,
+    inout  wire PB7,
+    output wire PC,
+    input  wire TOD,
+    inout  wire CNT,
+    inout  wire SP,
+    input  wire RS0,
+    input  wire RS1,
+    input  wire RS2,
+    input  wire RS3,
+    inout  wire RES,
+    inout  wire DB0,
+    inout  wire DB1,
+    inout  wire DB2,
+    inout  wire DB3,
+    inout  wire DB4,
+    inout  wire DB5,
+    inout  wire DB6,
+    inout  wire DB7,
+    input  wire PHI2,
+    input  wire FLAG,
+    input  wire CS,
+    input  wire R_W,
+    output wire IRQ,
+    output wire SPI_SS
+);
+
+    logic       phi2;
+    logic [7:0] db_o;
+    logic       db_oe;
+    logic [7:0] pa_o;
+    logic [7:0] pa_oe;
+    logic [7:0] pb_o;
+    logic [7:0] pb_oe;
+    logic       pc_n;
+    logic       cnt_oe;
+    logic       sp_oe;
+    logic       irq_n;
+    logic       rs2;
+    logic       rs3;
+    logic       res_i;
+    logic       res_oe;
+    logic       res_n;
+    logic       ready;
+    logic [7:0] flash_db_o;
+    logic       flash_db_oe;
+    logic       update;
+    logic       spi_oe;
+    logic       spi_sck;
+    logic       spi_so;
+    logic [7:0] perf_db_o;
+    logic       perf_db_oe;
+    logic       perf_window;
+    logic [7:0] la_db_o;
+    logic       la_db_oe;
+    logic       la_window;
+    logic [7:0] pipe_db_o;
+    logic       pipe_db_oe;
+    logic       pipe_window;
+    logic [7:0] pipe_pa_oe;
+    logic [7:0] pipe_pb_oe;
+    logic       pipe_pc_n;
+    logic [1:0] timer_event;
+    logic       timer_tick;
+
+    // RS2, RS3 and RES are on the RGB0 - RGB2 open drain pads, which are
+    // only accessible via SB_IO_OD.
+    SB_IO_OD #(
+        .PIN_TYPE (6'b000001)
+    ) rs2_io (
+        .PACKAGEPIN (RS2),
+        .DIN0       (rs2)
+    );
+
+    SB_IO_OD #(
+        .PIN_TYPE (6'b000001)
+    ) rs3_io (
+        .PACKAGEPIN (RS3),
+        .DIN0       (rs3)
+    );
+
+    SB_IO_OD #(
+        .PIN_TYPE (6'b101001)
+    ) res_io (
+        .PACKAGEPIN   (RES),
+        .OUTPUTENABLE (res_oe),
+        .DOUT0        (1'b0),
+        .DIN0         (res_i)
+    );
+
+    redip_phi2 #(
+        .INVERT (PHI2_INV),
+        .GBIN   (PHI2_GBIN)
+    ) clock (
+        .pad  (PHI2),
+        .phi2 (phi2)
+    );
+
+    redip_reset #(
+        .HOLD (RES_HOLD)
+    ) reset (
+        .phi2   (phi2),
+        .res_i  (res_i),
+        .res_oe (res_oe),
+        .res_n  (res_n),
+        .ready  (ready)
+    );
+
+    redip_timebase #(
+        .SOURCE (TIMER_SOURCE),
+        .HZ     (TIMER_HZ)
+    ) timebase (
+        .phi2 (phi2),
+        .cnt  (CNT),
+        .tick (timer_tick)
+    );
+
+    // Chip select, shared by the hidden register modes.
+    wire sel = !CS;
+
+    redip_flash #(
+        .ENABLE (FLASH_UPDATE)
+    ) flash (
+        .phi2    (phi2),
+        .res_n   (res_n),
+        .sel     (sel && !perf_window && !la_window && !pipe_window),
+        .r_w     (R_W),
+        .rs      ({ rs3, rs2, RS1, RS0 }),
+        .db_i    ({ DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 }),
+        .db_o    (flash_db_o),
+        .db_oe   (flash_db_oe),
+        .update  (update),
+        .spi_oe  (spi_oe),
+        .spi_sck (spi_sck),
+        .spi_so  (spi_so),
+        .spi_si  (PB6)
+    );
+
+    redip_perf #(
+        .ENABLE (PERF_COUNTERS)
+    ) perf (
+        .phi2        (phi2),
+        .res_n       (res_n),
+        .sel         (sel && !update && !la_window && !pipe_window),
+        .r_w         (R_W),
+        .rs          ({ rs3, rs2, RS1, RS0 }),
+        .db_i        ({ DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 }),
+        .db_o        (perf_db_o),
+        .db_oe       (perf_db_oe),
+        .window      (perf_window),
+        .irq         (!irq_n),
+        .timer_event (timer_event)
+    );
+
+    redip_la #(
+        .ENABLE (LOGIC_ANALYZER),
+        .DEPTH  (LA_DEPTH)
+    ) la (
+        .phi2   (phi2),
+        .res_n  (res_n),
+        .sel    (sel && !update && !perf_window && !pipe_window),
+        .r_w    (R_W),
+        .rs     ({ rs3, rs2, RS1, RS0 }),
+        .db_i   ({ DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 }),
+        .db_o   (la_db_o),
+        .db_oe  (la_db_oe),
+        .window (la_window),
+        .probe  ({ PB7, PB6, PB5, PB4, PB3, PB2, PB1, PB0,
+                   PA7, PA6, PA5, PA4, PA3, PA2, PA1, PA0,
+                   res_i, irq_n, sel, R_W, { rs3, rs2, RS1, RS0 },
+                   DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 })
+    );
+
+    redip_pipe #(
+        .ENABLE (PORT_PIPE)
+    ) pipe (
+        .phi2   (phi2),
+        .res_n  (res_n),
+        .sel    (sel && !update && !perf_window && !la_window),
+        .r_w    (R_W),
+        .rs     ({ rs3, rs2, RS1, RS0 }),
+        .db_i   ({ DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 }),
+        .db_o   (pipe_db_o),
+        .db_oe  (pipe_db_oe),
+        .window (pipe_window),
+        .pa_i   ({ PA7, PA6, PA5, PA4, PA3, PA2, PA1, PA0 }),
+        .pa_oe  (pipe_pa_oe),
+        .pb_i   ({ PB7, PB6, PB5, PB4, PB3, PB2, PB1, PB0 }),
+        .pb_oe  (pipe_pb_oe),
+        .pc_n   (pipe_pc_n),
+        .flag_n (FLAG)
+    );
+
+    cia #(
+        .TIMER_MAC16 (TIMER_MAC16),
+        .OLD_6526    (OLD_6526),
+        .TOD_BINARY  (TOD_BINARY),
+        .LOW_POWER   (LOW_POWER)
+    ) core (
+        .phi2        (phi2),
+        .res_n       (res_n && !update),
+        .cs_n        (CS || perf_window || la_window || pipe_window),
+        .r_w         (R_W),
+        .rs          ({ rs3, rs2, RS1, RS0 }),
+        .db_i        ({ DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 }),
+        .db_o        (db_o),
+        .db_oe       (db_oe),
+        .pa_i        ({ PA7, PA6, PA5, PA4, PA3, PA2, PA1, PA0 }),
+        .pa_o        (pa_o),
+        .pa_oe       (pa_oe),
+        .pb_i        ({ PB7, PB6, PB5, PB4, PB3, PB2, PB1, PB0 }),
+        .pb_o        (pb_o),
+        .pb_oe       (pb_oe),
+        .pc_n        (pc_n),
+        .flag_n      (FLAG),
+        .tod         (TOD),
+        .timer_tick  (timer_tick),
+        .cnt_i       (CNT),
+        .cnt_oe      (cnt_oe),
+        .sp_i        (SP),
+        .sp_oe       (sp_oe),
+        .irq_n       (irq_n),
+        .timer_event (timer_event)
+    );
+
+    // Tri-state outputs, inferred as SB_IO by nextpnr.
+    assign { DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0 } =
+        db_oe && ready && !update ? db_o :
+        flash_db_oe ? flash_db_o :
+        perf_db_oe  ? perf_db_o  :
+        la_db_oe    ? la_db_o    :
+        pipe_db_oe  ? pipe_db_o  : 8'bz;
+
+    assign PA0 = pipe_pa_oe[0] ? 1'b0 : pa_oe[0] ? pa_o[0] : 1'bz;
+    assign PA1 = pipe_pa_oe[1] ? 1'b0 : pa_oe[1] ? pa_o[1] : 1'bz;
+    assign PA2 = pipe_pa_oe[2] ? 1'b0 : pa_oe[2] ? pa_o[2] : 1'bz;
+    assign PA3 = pipe_pa_oe[3] ? 1'b0 : pa_oe[3] ? pa_o[3] : 1'bz;
+    assign PA4 = pipe_pa_oe[4] ? 1'b0 : pa_oe[4] ? pa_o[4] : 1'bz;
+    assign PA5 = pipe_pa_oe[5] ? 1'b0 : pa_oe[5] ? pa_o[5] : 1'bz;
+    assign PA6 = pipe_pa_oe[6] ? 1'b0 : pa_oe[6] ? pa_o[6] : 1'bz;
+    assign PA7 = pipe_pa_oe[7] ? 1'b0 : pa_oe[7] ? pa_o[7] : 1'bz;
+
+    assign PB0 = pipe_pb_oe[0] ? 1'b0 : pb_oe[0] ? pb_o[0] : 1'bz;
+    assign PB1 = pipe_pb_oe[1] ? 1'b0 : pb_oe[1] ? pb_o[1] : 1'bz;
+    assign PB2 = pipe_pb_oe[2] ? 1'b0 : pb_oe[2] ? pb_o[2] : 1'bz;
+    assign PB3 = pipe_pb_oe[3] ? 1'b0 : pb_oe[3] ? pb_o[3] : 1'bz;
+    assign PB4 = pipe_pb_oe[4] ? 1'b0 : pb_oe[4] ? pb_o[4] : 1'bz;
+    assign PB5 = pipe_pb_oe[5] ? 1'b0 : pb_oe[5] ? pb_o[5] : 1'bz;
+    assign PB6 = pipe_pb_oe[6] ? 1'b0 : pb_oe[6] ? pb_o[6] : 1'bz;
+    assign PB7 = spi_oe ? spi_sck : pipe_pb_oe[7] ? 1'b0 : pb_oe[7] ? pb_o[7] : 1'bz;
+
+    // CNT, SP and PC start out low from configuration, and are held high
+    // until the core has been reset, see redip_reset.sv.
+    assign PC  = spi_oe ? spi_so : !ready || (pc_n && pipe_pc_n);
+    assign CNT = cnt_oe && ready ? 1'b0 : 1'bz;
+    assign SP  = sp_oe  && ready ? 1'b0 : 1'bz;
+    assign IRQ = irq_n || !ready ? 1'bz : 1'b0;
+
+    // SPI_SS is pulled high by R19 when not driven.
+    assign SPI_SS = spi_oe ? 1'b0 : 1'bz;
+
+endmodule
@@ -0,0 +1,66 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Byte FIFO of DEPTH entries in EBR.
+//
+// push and pop take effect on the falling edge of PHI2, and are ignored when
+// the FIFO is full or empty, respectively. head is read from EBR on the
+// rising edge of PHI2, so it is valid while PHI2 is high, and a byte pushed
+// into an empty FIFO can be popped in the following cycle. flush empties the
+// FIFO, and overrides push and pop.
+module redip_fifo #(
+    parameter DEPTH = 512
+) (
+    input  logic       phi2,
+    input  logic       flush,
+    input  logic       push,
+    input  logic [7:0] din,
+    input  logic       pop,
+    output logic [7:0] head,
+    output logic       empty,
+    output logic       full
+);
+
+    localparam AW = $clog2(DEPTH);
+
+    // Inferred as SB_RAM40_4K.
+    logic [7:0] buffer [0:DEPTH-1];
+
+    // One extra pointer bit tells a full FIFO from an empty one.
+    logic [AW:0] wptr;
+    logic [AW:0] rptr;
+
+    initial begin
+        wptr = 0;
+        rptr = 0;
+    end
+
+    assign empty = wptr == rptr;
+    assign full  = wptr == { !rptr[AW], rptr[AW-1:0] };
+
+    always_ff @(posedge phi2) begin
+        head <= buffer[rptr[AW-1:0]];
+    end
+
+    always_ff @(negedge phi2) begin
+        if (flush) begin
+            wptr <= 0;
+            rptr <= 0;
+        end else begin
+            if (push && !full) begin
+                buffer[wptr[AW-1:0]] <= din;
+                wptr                 <= wptr + 1'b1;
+            end
+            if (pop && !empty) begin
+                rptr <= rptr + 1'b1;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,387 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// In-system flash update over the host bus.
+//
+// Writing the bytes 72h 44h 49h 50h ("rDIP") to register 0, see
+// redip_unlock.sv, enters update mode. The core is then held in reset, and
+// the chip select instead accesses these registers, decoded on RS0 - RS1:
+//
+//   0: DATA    W  Page buffer, written from offset 0 after a write of ADDR
+//   1: ADDR    W  Flash address, written most significant byte first
+//   2: CMD     W  Command, see below
+//      STATUS  R  { error, count[2:0], ~error, ~count[2:0] }
+//   3: ID      R  F1h
+//
+// Commands are the AT25SF081 opcodes, with ADDR and the 256 byte page buffer:
+//
+//   20h: erase the 4kB sector at ADDR
+//   D8h: erase the 64kB block at ADDR
+//   02h: program the page at ADDR from the page buffer
+//   03h: verify the page at ADDR against the page buffer
+//   B0h - B3h: warmboot into image 0 - 3
+//   00h: leave update mode
+//
+// Each command wakes the flash (ABh), and erase and program are preceded by
+// write enable (06h) and followed by status polling (05h). count is
+// incremented when a command has completed, and error is set if the command
+// was unknown or a verify failed. Writes are ignored while a command is in
+// progress.
+//
+// While SPI_SS is low, the bus switch U4 disconnects PHI2, CS, R/W and
+// DB3 - DB7, and the host reads an undriven bus. The SPI transfers therefore
+// run from the internal 48MHz oscillator divided by 4, and the host must
+// poll STATUS, expecting the complement pattern and the next count twice in
+// a row, rather than rely on a busy bit. Every PHI2 domain register except
+// the acknowledge synchronizer holds while a command is in progress, so that
+// PHI2 glitches while PHI2 is disconnected have no effect. DB0 - DB7 are
+// never driven while SPI_SS is low.
+//
+// SPI_SCK and SPI_SO are shared with port pins, and are only driven, through
+// spi_oe, while SPI_SS is low, as in redip_bootsel.sv.
+//
+// ENABLE = 0 builds no logic, with update tied low.
+module redip_flash #(
+    parameter ENABLE = 0
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       sel,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    output logic       update,
+    output logic       spi_oe,
+    output logic       spi_sck,
+    output logic       spi_so,
+    input  logic       spi_si
+);
+
+    generate
+        if (ENABLE) begin : flash
+
+            // Register addresses.
+            localparam DATA   = 2'h0;
+            localparam ADDR   = 2'h1;
+            localparam CMD    = 2'h2;
+            localparam STATUS = 2'h2;
+            localparam ID     = 2'h3;
+
+            // Commands.
+            localparam [7:0] SECTOR_ERASE = 8'h20;
+            localparam [7:0] BLOCK_ERASE  = 8'hD8;
+            localparam [7:0] PROGRAM      = 8'h02;
+            localparam [7:0] VERIFY       = 8'h03;
+            localparam [7:0] EXIT         = 8'h00;
+
+            // SPI opcodes.
+            localparam [7:0] WAKE = 8'hAB;
+            localparam [7:0] WREN = 8'h06;
+            localparam [7:0] RDSR = 8'h05;
+
+            logic unlock;
+
+            redip_unlock #(
+                .KEY (32'h72444950)
+            ) key (
+                .phi2   (phi2),
+                .sel    (sel && !update),
+                .wr     (sel && !r_w && rs == 4'h0),
+                .db_i   (db_i),
+                .unlock (unlock)
+            );
+
+            // Page buffer, written from the PHI2 domain, and read from the
+            // oscillator domain. Inferred as SB_RAM40_4K.
+            logic [7:0] buffer [0:255];
+
+            // PHI2 domain.
+            logic [7:0]  wptr;
+            logic [23:0] addr;
+            logic [7:0]  cmd;
+            logic        req;
+            logic        busy;
+            logic [2:0]  count;
+            logic [9:0]  osc_delay;
+            logic        ack_s, ack_q, ack_seen;
+
+            // Oscillator domain.
+            logic        clk;
+            logic        req_s, req_q, req_seen;
+            logic        ack;
+            logic        error;
+            logic        boot;
+
+            initial begin
+                update    = 1'b0;
+                wptr      = 8'h00;
+                req       = 1'b0;
+                busy      = 1'b0;
+                count     = 3'd0;
+                osc_delay = 10'd0;
+                ack_seen  = 1'b0;
+                req_seen  = 1'b0;
+                ack       = 1'b0;
+                error     = 1'b0;
+                boot      = 1'b0;
+            end
+
+            wire wr   = update && sel && !r_w && !busy;
+            wire done = busy && ack_q != ack_seen;
+
+            always_ff @(negedge phi2) begin
+                ack_s <= ack;
+                ack_q <= ack_s;
+
+                if (done) begin
+                    busy     <= 1'b0;
+                    ack_seen <= ack_q;
+                    count    <= count + 1'b1;
+                end
+
+                if (!busy) begin
+                    if (unlock) begin
+                        update <= 1'b1;
+                        wptr   <= 8'h00;
+                    end else if (!res_n) begin
+                        update <= 1'b0;
+                    end
+
+                    // Start the oscillator, and enable its output after
+                    // 1024 PHI2 cycles, which covers its start-up time at
+                    // up to 4MHz PHI2.
+                    if (!update) begin
+                        osc_delay <= 10'd0;
+                    end else if (!&osc_delay) begin
+                        osc_delay <= osc_delay + 1'b1;
+                    end
+
+                    if (wr && rs[1:0] == DATA) begin
+                        buffer[wptr] <= db_i;
+                        wptr         <= wptr + 1'b1;
+                    end
+
+                    if (wr && rs[1:0] == ADDR) begin
+                        addr <= { addr[15:0], db_i };
+                        wptr <= 8'h00;
+                    end
+
+                    if (wr && rs[1:0] == CMD) begin
+                        if (db_i == EXIT) begin
+                            update <= 1'b0;
+                        end else begin
+                            cmd  <= db_i;
+                            req  <= !req;
+                            busy <= 1'b1;
+                        end
+                    end
+                end
+            end
+
+            SB_HFOSC #(
+                .CLKHF_DIV ("0b10")
+            ) osc (
+                .CLKHFPU (update),
+                .CLKHFEN (&osc_delay),
+                .CLKHF   (clk)
+            );
+
+            // Sequencer steps. Each SPI transfer is preceded by 128
+            // oscillator cycles (~11us) with SPI_SS high, which covers the
+            // flash wake-up time, and the minimum deselect time.
+            localparam S_IDLE  = 3'd0;
+            localparam S_WAKE  = 3'd1;
+            localparam S_WREN  = 3'd2;
+            localparam S_OP    = 3'd3;
+            localparam S_POLL  = 3'd4;
+            localparam S_CHECK = 3'd5;
+            localparam S_DONE  = 3'd6;
+
+            logic [2:0]  step;
+            logic [6:0]  gap;
+            logic        active;
+            logic        sck;
+            logic [2:0]  nbit;
+            logic [1:0]  nhdr;
+            logic [8:0]  ndata;
+            logic        in_data;
+            logic        compare;
+            logic [23:0] addr_q;
+            logic [7:0]  tx;
+            logic [7:0]  rx;
+            logic [7:0]  cur;
+            logic [7:0]  baddr;
+            logic [7:0]  bdata;
+
+            initial begin
+                step   = S_IDLE;
+                gap    = 7'd0;
+                active = 1'b0;
+                sck    = 1'b0;
+            end
+
+            wire is_erase = cmd == SECTOR_ERASE || cmd == BLOCK_ERASE;
+            wire is_write = is_erase || cmd == PROGRAM;
+            wire ready    = !active && &gap;
+            wire [7:0] rx_byte = { rx[6:0], spi_si };
+
+            always_ff @(posedge clk) begin
+                bdata <= buffer[baddr];
+            end
+
+            // SPI transfer of a step: an opcode, optionally followed by ADDR,
+            // and by n bytes from the page buffer, which are compared with
+            // the bytes read back if cmp is set.
+            logic       xfer;
+            logic [7:0] op;
+            logic       with_addr;
+            logic [8:0] n;
+            logic       cmp;
+            logic [2:0] next_step;
+
+            always_comb begin
+                xfer      = 1'b1;
+                op        = cmd;
+                with_addr = 1'b0;
+                n         = 9'd0;
+                cmp       = 1'b0;
+                next_step = S_DONE;
+                case (step)
+                    S_WAKE: begin
+                        op        = WAKE;
+                        next_step = is_write ? S_WREN : S_OP;
+                    end
+                    S_WREN: begin
+                        op        = WREN;
+                        next_step = S_OP;
+                    end
+                    S_OP: begin
+                        with_addr = 1'b1;
+                        n         = is_erase ? 9'd0 : 9'd256;
+                        cmp       = cmd == VERIFY;
+                        next_step = is_write ? S_POLL : S_DONE;
+                    end
+                    S_POLL: begin
+                        op        = RDSR;
+                        n         = 9'd1;
+                        next_step = S_CHECK;
+                    end
+                    default: begin
+                        xfer = 1'b0;
+                    end
+                endcase
+            end
+
+            always_ff @(posedge clk) begin
+                req_s <= req;
+                req_q <= req_s;
+
+                if (!active && !&gap) begin
+                    gap <= gap + 1'b1;
+                end
+
+                if (active) begin
+                    // SPI mode 0, sampling SPI_SI at the end of the SCK high
+                    // phase.
+                    sck <= !sck;
+                    if (sck) begin
+                        rx   <= rx_byte;
+                        tx   <= { tx[6:0], 1'b0 };
+                        nbit <= nbit + 1'b1;
+                        if (nbit == 3'd7) begin
+                            if (in_data && compare && rx_byte != cur) begin
+                                error <= 1'b1;
+                            end
+                            if (nhdr != 2'd0) begin
+                                tx     <= addr_q[23:16];
+                                addr_q <= { addr_q[15:0], 8'h00 };
+                                nhdr   <= nhdr - 1'b1;
+                            end else if (ndata != 9'd0) begin
+                                tx      <= bdata;
+                                cur     <= bdata;
+                                baddr   <= baddr + 1'b1;
+                                ndata   <= ndata - 1'b1;
+                                in_data <= 1'b1;
+                            end else begin
+                                active <= 1'b0;
+                                gap    <= 7'd0;
+                            end
+                        end
+                    end
+                end else if (ready && xfer) begin
+                    active  <= 1'b1;
+                    tx      <= op;
+                    nbit    <= 3'd0;
+                    nhdr    <= with_addr ? 2'd3 : 2'd0;
+                    ndata   <= n;
+                    in_data <= 1'b0;
+                    compare <= cmp;
+                    addr_q  <= addr;
+                    baddr   <= 8'h00;
+                    step    <= next_step;
+                end else if (ready) begin
+                    case (step)
+                        S_IDLE: begin
+                            if (req_q != req_seen) begin
+                                req_seen <= req_q;
+                                error    <= 1'b0;
+                                if (cmd[7:2] == 6'b101100) begin
+                                    boot <= 1'b1;
+                                end else if (is_write || cmd == VERIFY) begin
+                                    step <= S_WAKE;
+                                end else begin
+                                    error <= 1'b1;
+                                    step  <= S_DONE;
+                                end
+                            end
+                        end
+                        S_CHECK: begin
+                            // Status register bit 0: write in progress.
+                            step <= rx[0] ? S_POLL : S_DONE;
+                        end
+                        default: begin
+                            ack  <= !ack;
+                            step <= S_IDLE;
+                        end
+                    endcase
+                end
+            end
+
+            SB_WARMBOOT warmboot (
+                .BOOT (boot),
+                .S1   (cmd[1]),
+                .S0   (cmd[0])
+            );
+
+            always_comb begin
+                case (rs[1:0])
+                    STATUS:  db_o = { error, count, !error, ~count };
+                    ID:      db_o = 8'hF1;
+                    default: db_o = 8'hFF;
+                endcase
+            end
+
+            assign db_oe   = phi2 && update && sel && r_w && !active;
+            assign spi_oe  = active;
+            assign spi_sck = sck;
+            assign spi_so  = tx[7];
+
+        end else begin : no_flash
+            assign db_o    = 8'hFF;
+            assign db_oe   = 1'b0;
+            assign update  = 1'b0;
+            assign spi_oe  = 1'b0;
+            assign spi_sck = 1'b0;
+            assign spi_so  = 1'b0;
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,188 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Bus logic analyzer, capturing into EBR.
+//
+// probe is written to a ring buffer of DEPTH samples on every falling edge
+// of PHI2 while armed, i.e. with the levels seen by the core registers:
+//
+//   7 - 0:   DB7 - DB0
+//   11 - 8:  RS3 - RS0
+//   12:      R/W
+//   13:      chip selected
+//   14:      IRQ (IRQA and IRQB for the PIA), low active
+//   15:      RES
+//   23 - 16: PA7 - PA0
+//   31 - 24: PB7 - PB0
+//
+// The trigger is the first sample for which (probe ^ value) & mask is zero,
+// or a forced trigger. post more samples are recorded after it, and the
+// capture is then done. post must be less than DEPTH. Samples older than
+// the arm command read as left over from the previous capture.
+//
+// Writing the bytes 72h 42h 4Ch 41h ("rBLA") to register 0, see
+// redip_unlock.sv, opens the window. While it is open, chip accesses go to
+// the window rather than to the core, which keeps running:
+//
+//   Write register 0: 01h arm, 02h force trigger, 03h rewind the dump
+//   Read register 0:  { done, triggered, armed, 5'b00000 }
+//   Write register 1: mask, value (MSB first), post (16 bit, MSB first)
+//   Read register 1:  dump, oldest sample first, LSB first
+//   Read register 2:  log2(DEPTH)
+//   Write register 3: close the window
+//
+// The dump starts at the oldest sample when the capture is done. The next
+// dump byte is read from EBR on the rising edge of PHI2, so a dump read is
+// timed from the rising edge rather than from RS0 - RS1, see README.md. A
+// host reset also closes the window, but does not stop a capture, so the
+// trigger may be set on RES.
+//
+// ENABLE = 0 builds no logic, with window tied low.
+module redip_la #(
+    parameter ENABLE = 0,
+    parameter DEPTH  = 512
+) (
+    input  logic        phi2,
+    input  logic        res_n,
+    input  logic        sel,
+    input  logic        r_w,
+    input  logic [3:0]  rs,
+    input  logic [7:0]  db_i,
+    output logic [7:0]  db_o,
+    output logic        db_oe,
+    output logic        window,
+    input  logic [31:0] probe
+);
+
+    generate
+        if (ENABLE) begin : la
+
+            localparam       AW         = $clog2(DEPTH);
+            localparam [7:0] LOG2_DEPTH = AW;
+
+            logic unlock;
+
+            redip_unlock #(
+                .KEY (32'h72424C41)
+            ) key (
+                .phi2   (phi2),
+                .sel    (sel && !window),
+                .wr     (sel && !r_w && rs == 4'h0),
+                .db_i   (db_i),
+                .unlock (unlock)
+            );
+
+            // Capture buffer, inferred as SB_RAM40_4K.
+            logic [31:0] buffer [0:DEPTH-1];
+
+            logic [31:0]   mask;
+            logic [31:0]   value;
+            logic [15:0]   post;
+            logic [15:0]   remaining;
+            logic          armed;
+            logic          triggered;
+            logic          done;
+            logic          force_trigger;
+            logic [AW-1:0] wptr;
+            logic [AW-1:0] rptr;
+            logic [1:0]    rbyte;
+            logic [31:0]   dump;
+
+            initial begin
+                window        = 1'b0;
+                armed         = 1'b0;
+                triggered     = 1'b0;
+                done          = 1'b0;
+                force_trigger = 1'b0;
+            end
+
+            wire recording = armed && !done;
+            wire hit       = ((probe ^ value) & mask) == 32'd0 || force_trigger;
+            wire last      = triggered ? remaining == 16'd1 : hit && post == 16'd0;
+
+            wire wr = window && sel && !r_w;
+            wire rd = window && sel && r_w;
+
+            always_ff @(posedge phi2) begin
+                dump <= buffer[rptr];
+            end
+
+            always_ff @(negedge phi2) begin
+                if (recording) begin
+                    buffer[wptr] <= probe;
+                    wptr         <= wptr + 1'b1;
+
+                    if (!triggered) begin
+                        if (hit) begin
+                            triggered     <= 1'b1;
+                            remaining     <= post;
+                            force_trigger <= 1'b0;
+                        end
+                    end else begin
+                        remaining <= remaining - 1'b1;
+                    end
+
+                    if (last) begin
+                        done  <= 1'b1;
+                        rptr  <= wptr + 1'b1;
+                        rbyte <= 2'd0;
+                    end
+                end
+
+                if (rd && rs[1:0] == 2'd1) begin
+                    rbyte <= rbyte + 1'b1;
+                    if (rbyte == 2'd3) rptr <= rptr + 1'b1;
+                end
+
+                if (wr && rs[1:0] == 2'd0) begin
+                    case (db_i)
+                        8'h01: begin
+                            armed     <= 1'b1;
+                            triggered <= 1'b0;
+                            done      <= 1'b0;
+                        end
+                        8'h02: force_trigger <= 1'b1;
+                        8'h03: begin
+                            rptr  <= wptr;
+                            rbyte <= 2'd0;
+                        end
+                        default: ;
+                    endcase
+                end
+
+                if (wr && rs[1:0] == 2'd1) begin
+                    { mask, value, post } <= { mask[23:0], value, post, db_i };
+                end
+
+                if (unlock) begin
+                    window <= 1'b1;
+                end else if (!res_n || wr && rs[1:0] == 2'd3) begin
+                    window <= 1'b0;
+                end
+            end
+
+            always_comb begin
+                case (rs[1:0])
+                    2'd0:    db_o = { done, triggered, armed, 5'b00000 };
+                    2'd1:    db_o = dump[8*rbyte +: 8];
+                    2'd2:    db_o = LOG2_DEPTH;
+                    default: db_o = 8'hFF;
+                endcase
+            end
+
+            assign db_oe = phi2 && window && sel && r_w;
+
+        end else begin : no_la
+            assign db_o   = 8'hFF;
+            assign db_oe  = 1'b0;
+            assign window = 1'b0;
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,158 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Performance counters, read through a hidden register window.
+//
+// 32 bit counters, cleared by configuration only, and wrapping:
+//
+//   00h - 0Fh: reads of register 0 - 15
+//   10h - 1Fh: writes of register 0 - 15
+//   20h:       PHI2 cycles
+//   21h:       IRQ assertions (IRQ, or IRQA / IRQB, going low)
+//   22h:       Timer A / T1 underflows
+//   23h:       Timer B / T2 underflows
+//
+// Writing the bytes 72h 50h 52h 46h ("rPRF") to register 0, see
+// redip_unlock.sv, opens the window. While it is open, chip accesses go to
+// the window rather than to the core, which keeps running, and are not
+// counted:
+//
+//   Write register 0: snapshot the counter given by the data, 00h - 23h
+//   Read register 0 - 3: snapshot bits 7 - 0, ..., 31 - 24
+//   Write register 1 - 3: close the window
+//
+// The snapshot can be read from the second cycle after the write. A host
+// reset also closes the window.
+//
+// The register counters are kept in EBR, and incremented by a read on the
+// rising edge of PHI2 following the access, and a write on the falling edge.
+// Accesses in consecutive cycles are pipelined.
+//
+// ENABLE = 0 builds no logic, with window tied low.
+module redip_perf #(
+    parameter ENABLE = 0
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       sel,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    output logic       window,
+    input  logic       irq,
+    input  logic [1:0] timer_event
+);
+
+    generate
+        if (ENABLE) begin : perf
+
+            logic unlock;
+
+            redip_unlock #(
+                .KEY (32'h72505246)
+            ) key (
+                .phi2   (phi2),
+                .sel    (sel && !window),
+                .wr     (sel && !r_w && rs == 4'h0),
+                .db_i   (db_i),
+                .unlock (unlock)
+            );
+
+            // Register access counters, indexed by { write, register }.
+            logic [31:0] counters [0:31];
+            integer      i;
+
+            initial begin
+                for (i = 0; i < 32; i = i + 1) begin
+                    counters[i] = 32'd0;
+                end
+            end
+
+            // Event counters.
+            logic [31:0] cycles;
+            logic [31:0] irqs;
+            logic [31:0] timer_a;
+            logic [31:0] timer_b;
+            logic        irq_q;
+
+            // Access pipeline, and snapshot.
+            logic        count;
+            logic [4:0]  index;
+            logic        pending;
+            logic [5:0]  select;
+            logic [31:0] ram_q;
+            logic [31:0] snap;
+
+            initial begin
+                window  = 1'b0;
+                cycles  = 32'd0;
+                irqs    = 32'd0;
+                timer_a = 32'd0;
+                timer_b = 32'd0;
+                irq_q   = 1'b0;
+                count   = 1'b0;
+                pending = 1'b0;
+            end
+
+            always_ff @(posedge phi2) begin
+                ram_q <= counters[pending ? select[4:0] : index];
+            end
+
+            always_ff @(negedge phi2) begin
+                cycles <= cycles + 1'b1;
+
+                irq_q <= irq;
+                if (irq && !irq_q) irqs <= irqs + 1'b1;
+
+                if (timer_event[0]) timer_a <= timer_a + 1'b1;
+                if (timer_event[1]) timer_b <= timer_b + 1'b1;
+
+                if (count) counters[index] <= ram_q + 1'b1;
+
+                count <= sel && !window;
+                index <= { !r_w, rs };
+
+                if (pending) begin
+                    pending <= 1'b0;
+                    case (select)
+                        6'h20:   snap <= cycles;
+                        6'h21:   snap <= irqs;
+                        6'h22:   snap <= timer_a;
+                        6'h23:   snap <= timer_b;
+                        default: snap <= select[5] ? 32'd0 : ram_q;
+                    endcase
+                end
+
+                if (unlock) begin
+                    window <= 1'b1;
+                end else if (!res_n) begin
+                    window <= 1'b0;
+                end else if (window && sel && !r_w) begin
+                    if (rs[1:0] == 2'd0) begin
+                        select  <= db_i[5:0];
+                        pending <= 1'b1;
+                    end else begin
+                        window <= 1'b0;
+                    end
+                end
+            end
+
+            assign db_o  = snap[8*rs[1:0] +: 8];
+            assign db_oe = phi2 && window && sel && r_w;
+
+        end else begin : no_perf
+            assign db_o   = 8'hFF;
+            assign db_oe  = 1'b0;
+            assign window = 1'b0;
+        end
+    endgenerate
+
+endmodule
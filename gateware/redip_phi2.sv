@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// PHI2 clock input.
+//
+// PHI2 is the only clock. It is placed on a global buffer explicitly, rather
+// than relying on nextpnr to promote it, so that all flip-flops and the
+// DB0 - DB7 output enables see the same PHI2 with low skew. The iCE40 inputs
+// have no hysteresis; slow or noisy PHI2 edges must be conditioned on the
+// board, see hardware/documentation/clocking.md.
+//
+// INVERT: the PHI2 pad carries inverted PHI2, as with a Schmitt inverter in
+// the PHI2 path on the board. The inversion is done in front of the global
+// buffer, so that the rest of the design is unchanged.
+//
+// GBIN: PHI2 is on a global buffer input pad, which drives the global buffer
+// directly through SB_GB_IO instead of through general routing. With INVERT,
+// the inversion still needs a LUT, and general routing is used.
+module redip_phi2 #(
+    parameter INVERT = 0,
+    parameter GBIN   = 0
+) (
+    input  wire pad,
+    output wire phi2
+);
+
+    generate
+        if (GBIN && !INVERT) begin : gbin
+            SB_GB_IO #(
+                .PIN_TYPE (6'b000001)
+            ) phi2_gb (
+                .PACKAGE_PIN          (pad),
+                .GLOBAL_BUFFER_OUTPUT (phi2)
+            );
+        end else begin : fabric
+            SB_GB phi2_gb (
+                .USER_SIGNAL_TO_GLOBAL_BUFFER (INVERT ? !pad : pad),
+                .GLOBAL_BUFFER_OUTPUT         (phi2)
+            );
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,233 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Parallel port pipe: PA and PB burst transfers through EBR FIFOs, with the
+// PC / FLAG handshake done in gateware.
+//
+// Writing the bytes 72h 50h 49h 50h ("rPIP") to register 0, see
+// redip_unlock.sv, opens the window. While it is open, chip accesses go to
+// the window rather than to the core, which keeps running:
+//
+//   Write register 0 / 1: push a byte into the PA / PB FIFO (output mode)
+//   Read register 0 / 1:  pop a byte from the PA / PB FIFO (input mode)
+//   Write register 2:     CTRL { 4'b0000, hs, out, pb_en, pa_en }
+//   Read register 2:      STATUS { 3'b000, busy, pb_full, pb_empty,
+//                                  pa_full, pa_empty }
+//   Write register 3:     close the window
+//
+// Each transfer moves one byte on every enabled port, with one PC strobe.
+// With out set, the enabled ports are outputs: once every enabled FIFO holds
+// a byte, they are popped onto the port pins, and PC is pulled low for one
+// cycle in the cycle after. With hs set, the next transfer then waits for a
+// falling edge on FLAG from the peripheral; without it, a transfer takes
+// three cycles. With out clear, the enabled ports are inputs: a falling edge
+// on FLAG pushes the port pins into the FIFOs, and PC is pulsed in the cycle
+// after as acknowledge. While a FIFO is full, the push, and thus the
+// acknowledge, wait for the host to read.
+//
+// Writing CTRL empties both FIFOs. Closing the window, or a host reset,
+// empties them and stops the transfers, and the ports return to the core.
+// This PC strobe is ANDed with the core one, and pipe outputs are open drain
+// like the core ports, ANDed with the core outputs; the core port pins of a
+// port used for input should be left as inputs. FLAG still reaches the core
+// ICR, so the FLAG interrupt should be masked.
+//
+// The FIFO heads are read from EBR on the rising edge of PHI2, so that reads
+// of registers 0 and 1 are timed from the rising edge rather than from
+// RS0 - RS1, see README.md.
+//
+// ENABLE = 0 builds no logic, with window tied low.
+module redip_pipe #(
+    parameter ENABLE = 0,
+    parameter DEPTH  = 512
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       sel,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    output logic       window,
+    input  logic [7:0] pa_i,
+    output logic [7:0] pa_oe,
+    input  logic [7:0] pb_i,
+    output logic [7:0] pb_oe,
+    output logic       pc_n,
+    input  logic       flag_n
+);
+
+    generate
+        if (ENABLE) begin : pipe
+
+            logic unlock;
+
+            redip_unlock #(
+                .KEY (32'h72504950)
+            ) key (
+                .phi2   (phi2),
+                .sel    (sel && !window),
+                .wr     (sel && !r_w && rs == 4'h0),
+                .db_i   (db_i),
+                .unlock (unlock)
+            );
+
+            // Transfer stages.
+            localparam S_IDLE   = 2'd0;
+            localparam S_DATA   = 2'd1;
+            localparam S_STROBE = 2'd2;
+            localparam S_WAIT   = 2'd3;
+
+            logic       pa_en;
+            logic       pb_en;
+            logic       out;
+            logic       hs;
+            logic [1:0] stage;
+            logic       pending;
+            logic [7:0] pa_q;
+            logic [7:0] pb_q;
+            logic       flag_s, flag_q;
+
+            initial begin
+                window  = 1'b0;
+                pa_en   = 1'b0;
+                pb_en   = 1'b0;
+                out     = 1'b0;
+                hs      = 1'b0;
+                stage   = S_IDLE;
+                pending = 1'b0;
+                pa_q    = 8'hFF;
+                pb_q    = 8'hFF;
+                pc_n    = 1'b1;
+            end
+
+            wire wr = window && sel && !r_w;
+            wire rd = window && sel && r_w;
+
+            wire close     = !res_n || wr && rs[1:0] == 2'd3;
+            wire flush     = close || wr && rs[1:0] == 2'd2;
+            wire flag_fall = !flag_s && flag_q;
+
+            logic [7:0] pa_head, pb_head;
+            logic       pa_empty, pa_full;
+            logic       pb_empty, pb_full;
+
+            // A transfer can start once every enabled FIFO has a byte to
+            // send, or room for a byte received.
+            wire ready = out ? (!pa_en || !pa_empty) && (!pb_en || !pb_empty) :
+                               (!pa_en || !pa_full)  && (!pb_en || !pb_full);
+            wire start = window && (pa_en || pb_en) && stage == S_IDLE && ready &&
+                         (out || pending);
+
+            redip_fifo #(
+                .DEPTH (DEPTH)
+            ) pa_fifo (
+                .phi2  (phi2),
+                .flush (flush),
+                .push  (out ? wr && rs[1:0] == 2'd0 : start && pa_en),
+                .din   (out ? db_i : pa_i),
+                .pop   (out ? start && pa_en : rd && rs[1:0] == 2'd0),
+                .head  (pa_head),
+                .empty (pa_empty),
+                .full  (pa_full)
+            );
+
+            redip_fifo #(
+                .DEPTH (DEPTH)
+            ) pb_fifo (
+                .phi2  (phi2),
+                .flush (flush),
+                .push  (out ? wr && rs[1:0] == 2'd1 : start && pb_en),
+                .din   (out ? db_i : pb_i),
+                .pop   (out ? start && pb_en : rd && rs[1:0] == 2'd1),
+                .head  (pb_head),
+                .empty (pb_empty),
+                .full  (pb_full)
+            );
+
+            always_ff @(negedge phi2) begin
+                flag_s <= flag_n;
+                flag_q <= flag_s;
+
+                case (stage)
+                    S_IDLE: begin
+                        if (start) begin
+                            if (out) begin
+                                if (pa_en) pa_q <= pa_head;
+                                if (pb_en) pb_q <= pb_head;
+                            end
+                            stage <= S_DATA;
+                        end
+                    end
+                    S_DATA: begin
+                        pc_n  <= 1'b0;
+                        stage <= S_STROBE;
+                    end
+                    S_STROBE: begin
+                        pc_n  <= 1'b1;
+                        stage <= out && hs ? S_WAIT : S_IDLE;
+                    end
+                    S_WAIT: begin
+                        if (flag_fall) stage <= S_IDLE;
+                    end
+                endcase
+
+                if (start) begin
+                    pending <= 1'b0;
+                end else if (flag_fall && !out) begin
+                    pending <= 1'b1;
+                end
+
+                if (wr && rs[1:0] == 2'd2) begin
+                    { hs, out, pb_en, pa_en } <= db_i[3:0];
+                end
+
+                if (flush) begin
+                    stage   <= S_IDLE;
+                    pending <= 1'b0;
+                    pa_q    <= 8'hFF;
+                    pb_q    <= 8'hFF;
+                    pc_n    <= 1'b1;
+                end
+
+                if (unlock) begin
+                    window <= 1'b1;
+                end else if (close) begin
+                    window <= 1'b0;
+                    pa_en  <= 1'b0;
+                    pb_en  <= 1'b0;
+                end
+            end
+
+            always_comb begin
+                case (rs[1:0])
+                    2'd0:    db_o = pa_head;
+                    2'd1:    db_o = pb_head;
+                    2'd2:    db_o = { 3'b000, stage != S_IDLE || pending,
+                                      pb_full, pb_empty, pa_full, pa_empty };
+                    default: db_o = 8'hFF;
+                endcase
+            end
+
+            assign db_oe = phi2 && window && sel && r_w;
+            assign pa_oe = {8{window && out && pa_en}} & ~pa_q;
+            assign pb_oe = {8{window && out && pb_en}} & ~pb_q;
+
+        end else begin : no_pipe
+            assign db_o   = 8'hFF;
+            assign db_oe  = 1'b0;
+            assign window = 1'b0;
+            assign pa_oe  = 8'h00;
+            assign pb_oe  = 8'h00;
+            assign pc_n   = 1'b1;
+        end
+    endgenerate
+
+endmodule
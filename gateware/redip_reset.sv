@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Power-on reset and RES hold-off.
+//
+// All flip-flops are cleared by configuration, so ready is low when the FPGA
+// enters user mode. The core is held in reset, and the bus outputs are kept
+// disabled, until the first falling edge of PHI2 has reset the core. Bus
+// cycles seen before this read an undriven DB0 - DB7, and IRQ is released.
+// The personalities apply ready in the same way to their other outputs whose
+// configuration state is not idle, such as CNT, SP and PC on the CIA.
+//
+// With HOLD > 0, RES is additionally pulled low for HOLD PHI2 cycles after
+// entering user mode. Since RES is the shared, open collector host reset
+// line, this extends the host reset so that the first CPU bus cycle comes
+// after the FPGA is configured. This relies on PHI2 running during reset.
+module redip_reset #(
+    parameter HOLD = 0
+) (
+    input  logic phi2,
+    input  logic res_i,
+    output logic res_oe,
+    output logic res_n,
+    output logic ready
+);
+
+    initial ready = 1'b0;
+
+    always_ff @(negedge phi2) begin
+        ready <= 1'b1;
+    end
+
+    assign res_n = res_i && ready;
+
+    generate
+        if (HOLD > 0) begin : hold
+            logic [$clog2(HOLD + 1)-1:0] count;
+
+            initial count = '0;
+
+            always_ff @(negedge phi2) begin
+                if (res_oe) count <= count + 1'b1;
+            end
+
+            assign res_oe = count != HOLD;
+        end else begin : no_hold
+            assign res_oe = 1'b0;
+        end
+    endgenerate
+
+endmodule
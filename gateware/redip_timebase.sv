@@ -0,0 +1,133 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Timer time base, for accelerator boards on which PHI2 at the socket is
+// stretched, gated or faster than the original system clock.
+//
+// tick enables one timer count (and TOD filter sample) in the current PHI2
+// cycle. SOURCE selects the reference:
+//
+//   0: PHI2, i.e. tick is tied high
+//   1: rising edges of the CNT pin, e.g. from a crystal oscillator
+//   2: the internal 48MHz oscillator divided by 2, and further by a
+//      fractional divider to HZ on average, e.g. 985248 or 1022727
+//
+// The reference edges are counted in their own clock domain in a 12 bit Gray
+// code counter, which is synchronized to PHI2. Each PHI2 cycle then takes at
+// most one count, so PHI2 must on average be at least as fast as the
+// reference, and stretched or gated PHI2 cycles are made up for in the
+// following cycles, at the difference of the two rates. Up to 4095 counts may
+// be outstanding, i.e. PHI2 may stop for up to 4095 reference periods, 4.1ms
+// at 1MHz, less any counts still to be made up from earlier stalls. Beyond
+// that, counts are lost in multiples of 4096. sim/timebase_check.cpp checks
+// this with CNT as the reference.
+//
+// SOURCE = 1: CNT is also the serial port clock and a timer count source, and
+// must not be driven low by the serial port in output mode. The reference
+// must have clean edges; a slow edge through the CNT pull-up may be counted
+// more than once.
+//
+// SOURCE = 2: the software timing is only as accurate as SB_HFOSC, which is
+// much less accurate than a crystal, see the iCE40 Ultra datasheet. The
+// oscillator cannot also be used by redip_flash.sv.
+module redip_timebase #(
+    parameter SOURCE = 0,
+    parameter HZ     = 985248
+) (
+    input  logic phi2,
+    input  logic cnt,
+    output logic tick
+);
+
+    generate
+        if (SOURCE == 0) begin : phi2_ref
+            assign tick = 1'b1;
+        end else begin : ext_ref
+
+            logic rclk;
+            logic ren;
+
+            if (SOURCE == 1) begin : cnt_ref
+                assign rclk = cnt;
+                assign ren  = 1'b1;
+            end else begin : osc_ref
+                localparam [24:0] OSC_HZ = 24000000;
+                localparam [24:0] STEP   = HZ;
+
+                logic [24:0] phase;
+
+                initial begin
+                    phase = 25'd0;
+                end
+
+                SB_HFOSC #(
+                    .CLKHF_DIV ("0b01")
+                ) osc (
+                    .CLKHFPU (1'b1),
+                    .CLKHFEN (1'b1),
+                    .CLKHF   (rclk)
+                );
+
+                // Phase accumulator modulo OSC_HZ, with one reference edge
+                // per wrap.
+                assign ren = phase >= OSC_HZ - STEP;
+
+                always_ff @(posedge rclk) begin
+                    phase <= ren ? phase + STEP - OSC_HZ : phase + STEP;
+                end
+            end
+
+            localparam W = 12;
+
+            // Reference domain.
+            logic [W-1:0] count;
+            logic [W-1:0] gray;
+
+            // PHI2 domain.
+            logic [W-1:0] gray_s, gray_q;
+            logic [W-1:0] taken;
+            logic [W-1:0] seen;
+
+            initial begin
+                count  = 0;
+                gray   = 0;
+                gray_s = 0;
+                gray_q = 0;
+                taken  = 0;
+            end
+
+            wire [W-1:0] count_next = count + 1'b1;
+
+            always_ff @(posedge rclk) begin
+                if (ren) begin
+                    count <= count_next;
+                    gray  <= count_next ^ (count_next >> 1);
+                end
+            end
+
+            always_comb begin
+                seen[W-1] = gray_q[W-1];
+                for (int i = W - 2; i >= 0; i--) begin
+                    seen[i] = seen[i+1] ^ gray_q[i];
+                end
+            end
+
+            assign tick = seen != taken;
+
+            always_ff @(negedge phi2) begin
+                gray_s <= gray;
+                gray_q <= gray_s;
+
+                if (tick) taken <= taken + 1'b1;
+            end
+
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,50 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// Magic write sequence detector for hidden register modes.
+//
+// unlock is asserted in the cycle of the last of four consecutive chip
+// accesses which write the bytes of KEY, most significant byte first, to
+// register 0. Any other chip access restarts the sequence. Cycles without
+// chip select are ignored, so the host may run code between the writes, but
+// must not access the chip otherwise, e.g. from an interrupt handler.
+//
+// The writes also reach register 0 of the core, as for any write.
+module redip_unlock #(
+    parameter KEY = 32'h00000000
+) (
+    input  logic       phi2,
+    input  logic       sel,
+    input  logic       wr,
+    input  logic [7:0] db_i,
+    output logic       unlock
+);
+
+    localparam [31:0] K = KEY;
+
+    logic [1:0] match;
+
+    initial match = 2'd0;
+
+    wire [7:0] key   = K[8*(3 - match) +: 8];
+    wire       first = wr && db_i == K[31:24];
+
+    assign unlock = wr && db_i == key && match == 2'd3;
+
+    always_ff @(negedge phi2) begin
+        if (sel) begin
+            if (wr && db_i == key && !unlock) begin
+                match <= match + 1'b1;
+            end else begin
+                match <= first ? 2'd1 : 2'd0;
+            end
+        end
+    end
+
+endmodule
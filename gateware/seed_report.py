@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+# This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+# MOS 6526/8520/8521 CIA FPGA replacement.
+#
+# Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+# ----------------------------------------------------------------------------
+
+"""Collect make seeds results, and check them against a baseline.
+
+usage: seed_report.py -o <results.json> <image>-<seed>-report.json...
+       seed_report.py -c <baseline.json> [-t <percent>] <results.json>
+
+With -o, writes the PHI2 Fmax and worst slack, the Fmax of every clock, and
+the utilization of every seed, the best and worst seed of every image, and
+the build parameters of every image from <image>.params, to a JSON results
+file, and prints one line per image.
+
+With -c, prints the best and worst PHI2 Fmax of every image against the
+baseline, which is a results file from an earlier run (make seeds-baseline).
+Exits with status 1 if the best Fmax of an image is more than the tolerance,
+by default 1%, below its baseline, if any seed of an image misses the
+constraint of any clock, i.e. if timing closure depends on the seed, or if
+the baseline of an image was built with other parameters or another PHI2
+constraint. Images which are
+not in the baseline are reported, but not checked.
+"""
+
+import getopt
+import json
+import os
+import re
+import sys
+
+from timing_report import cell_counts, failing_clocks, fmax_of
+
+
+def collect(files):
+    images = {}
+    netlists = {}
+    params = {}
+
+    for name in files:
+        m = re.match(r"(.*)-([0-9]+)-report\.json$", os.path.basename(name))
+        if not m:
+            raise ValueError(f"{name}: not a make seeds report")
+        image, seed = m.group(1), m.group(2)
+
+        with open(name) as f:
+            report = json.load(f)
+        if image not in netlists:
+            base = os.path.join(os.path.dirname(name), os.pardir, image)
+            with open(base + ".json") as f:
+                netlists[image] = cell_counts(json.load(f))
+            with open(base + ".params") as f:
+                params[image] = f.read().strip()
+        luts, ffs = netlists[image]
+
+        try:
+            fmax, freq = fmax_of(report)
+        except ValueError as e:
+            raise ValueError(f"{name}: {e}")
+        result = images.setdefault(image, {"constraint": freq, "params": params[image],
+                                           "seeds": {}})
+        result["seeds"][seed] = {
+            "fmax": round(fmax, 2),
+            "slack": round(1000 / freq - 1000 / fmax, 2),
+            "clocks": {clk: round(c["achieved"], 2)
+                       for clk, c in report.get("fmax", {}).items()},
+            "failing": failing_clocks(report),
+            "lut": luts,
+            "ff": ffs,
+            "utilization": {bel: util["used"]
+                            for bel, util in report.get("utilization", {}).items()
+                            if util["used"]},
+        }
+
+    for result in images.values():
+        seeds = result["seeds"]
+        # As timing_report.py --best: seeds which meet every clock constraint
+        # first, then by PHI2 Fmax.
+        rank = lambda s: (not seeds[s]["failing"], seeds[s]["fmax"])
+        best = max(seeds, key=rank)
+        worst = min(seeds, key=rank)
+        result["best_seed"] = int(best)
+        result["best_fmax"] = seeds[best]["fmax"]
+        result["worst_seed"] = int(worst)
+        result["worst_fmax"] = seeds[worst]["fmax"]
+        result["seeds_ok"] = sum(not r["failing"] for r in seeds.values())
+
+    return {"images": images}
+
+
+def write(out, files):
+    try:
+        results = collect(files)
+    except ValueError as e:
+        print(e, file=sys.stderr)
+        return 2
+    with open(out, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+    print(f"{'image':12} {'MHz':>5} {'seeds':>5} {'ok':>3} {'best':>5} {'Fmax':>8} "
+          f"{'worst':>5} {'Fmax':>8}")
+    for image, r in sorted(results["images"].items()):
+        print(f"{image:12} {r['constraint']:5g} {len(r['seeds']):5} {r['seeds_ok']:3} "
+              f"{r['best_seed']:5} {r['best_fmax']:8.2f} {r['worst_seed']:5} {r['worst_fmax']:8.2f}")
+
+    return 0
+
+
+def check(baseline, results, tolerance):
+    with open(baseline) as f:
+        base = json.load(f)["images"]
+    with open(results) as f:
+        cur = json.load(f)["images"]
+
+    print(f"{'image':12} {'MHz':>5} {'baseline':>8} {'best':>8} {'worst':>8}  result")
+
+    failed = False
+    for image, r in sorted(cur.items()):
+        other = image in base and (base[image].get("params") != r["params"] or
+                                   base[image]["constraint"] != r["constraint"])
+        if image in base and not other:
+            ref = base[image]["best_fmax"]
+            regressed = r["best_fmax"] < ref * (1 - tolerance / 100)
+        else:
+            ref = float("nan")
+            regressed = False
+        fragile = r["seeds_ok"] < len(r["seeds"])
+
+        result = "ok"
+        if other:
+            result = "FAIL: baseline built with other parameters or FREQ"
+        elif regressed:
+            result = f"FAIL: more than {tolerance:g}% below baseline"
+        elif fragile:
+            result = f"FAIL: {len(r['seeds']) - r['seeds_ok']} seeds miss a constraint"
+        elif image not in base:
+            result = "not in baseline"
+        failed |= other or regressed or fragile
+
+        print(f"{image:12} {r['constraint']:5g} {ref:8.2f} {r['best_fmax']:8.2f} "
+              f"{r['worst_fmax']:8.2f}  {result}")
+
+    return 1 if failed else 0
+
+
+def main(argv):
+    try:
+        opts, args = getopt.getopt(argv[1:], "o:c:t:")
+    except getopt.GetoptError:
+        opts, args = [], []
+    opts = dict(opts)
+
+    try:
+        tolerance = float(opts.get("-t", 1))
+    except ValueError:
+        tolerance = -1
+
+    if "-o" in opts and args and "-c" not in opts and "-t" not in opts:
+        return write(opts["-o"], args)
+    if "-c" in opts and len(args) == 1 and "-o" not in opts and tolerance >= 0:
+        return check(opts["-c"], args[0], tolerance)
+
+    print(__doc__.split("\n\n")[1], file=sys.stderr)
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,435 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+// Checks of the timer and interrupt timing of the CIA variants, see OLD_6526
+// and TOD_BINARY in cia.sv, on the models of CIA_MODEL=6526A, 6526 and 8520,
+// and of the 6526A with TIMER_MAC16=1.
+//
+// usage: cia_errata [-l latch]
+//
+// Interrupt timing: Timer A is started in one-shot mode with the given latch
+// value (1 - 255), and the cycle of its underflow is found by reading TALO in
+// every cycle, as the cycle in which the counter reads zero. The ICR flag
+// must be returned by a read in the cycle after the underflow, on every
+// variant. IRQ must be low from the cycle after the underflow on the 6526A
+// and 8520, and from the second cycle after it on the 6526, which is
+// the timing of the real chips. The 6526 IRQ must thus also be exactly one
+// cycle later than the 6526A IRQ.
+//
+// Lost interrupts: a timer is started in one-shot mode, and ICR is read in
+// each cycle position around the underflow, followed by a second ICR read a
+// few cycles later. An interrupt is lost if neither read shows the timer
+// bit. This must never happen for Timer A, and for Timer B only on the old
+// 6526, in exactly one position: the cycle of the underflow.
+//
+// IRQ release: with the Timer A interrupt asserted, ICR is read, and the
+// cycles until IRQ is high are counted. This must be one cycle, i.e. IRQ is
+// released by the falling edge of PHI2 ending the read, on every variant.
+//
+// Read races: as for lost interrupts, but with the timer interrupt enabled.
+// IRQ is held if it is still low in the cycle after the read, and spurious
+// if it goes low again after a read which returned the timer bit. Neither
+// may happen in any position, on any variant.
+//
+// 8521: CIA_MODEL=8521 builds the 6526A logic, see cia.sv, so the 8521 model
+// is the 6526A model, and is not checked separately.
+//
+// TIMER_MAC16: the timer counters are SB_MAC16 accumulators, see
+// timer_counter.sv, simulated with the yosys model of the SB_MAC16. The
+// checks above are run on this model as on the 6526A, and a pseudo random
+// bus program with random port, FLAG, TOD, CNT and SP levels must give the
+// same pin levels in every cycle as on the 6526A model with the LUT
+// counters.
+//
+// 8520 TOD: the event counter is started, and short pulses are applied to
+// TOD. The counter must count every pulse, stay latched from a read of
+// register A until register 8 is read, and read zero in register B.
+//
+// Results are printed; the exit status is 1 if any check fails.
+
+#include "cia_model.h"
+#include "cia_pins.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace cia_pins;
+
+namespace {
+
+constexpr unsigned DB[8] = { DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7 };
+
+constexpr unsigned PA[8] = { PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7 };
+constexpr unsigned PB[8] = { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+
+constexpr unsigned TALO  = 0x4;
+constexpr unsigned TOD10 = 0x8;
+constexpr unsigned TODS  = 0x9;
+constexpr unsigned TODM  = 0xA;
+constexpr unsigned TODH  = 0xB;
+constexpr unsigned ICR   = 0xD;
+constexpr unsigned CRA   = 0xE;
+constexpr unsigned CRB   = 0xF;
+
+// Idle bus: chip deselected, pulled up inputs high.
+constexpr PinWord idle =
+    pin_mask(RES) | pin_mask(CS) | pin_mask(R_W) | pin_mask(FLAG) |
+    pin_mask(CNT) | pin_mask(SP) | pin_mask(IRQ);
+
+PinWord access(unsigned reg, bool read, unsigned data)
+{
+    PinWord w = idle & ~pin_mask(CS);
+    w = set_pin(w, R_W, read);
+    w = set_pin(w, RS0, reg);
+    w = set_pin(w, RS1, reg >> 1);
+    w = set_pin(w, RS2, reg >> 2);
+    w = set_pin(w, RS3, reg >> 3);
+    return read ? w : w | port_mask(DB, data);
+}
+
+// Runs the model one cycle at a time.
+template <typename M>
+class Host {
+public:
+    PinWord cycle(PinWord w)
+    {
+        PinWord o;
+        model.load(&w, &o, 1);
+        model.step(1);
+        return o;
+    }
+
+    void run(const std::vector<PinWord>& program)
+    {
+        for (PinWord w : program) {
+            cycle(w);
+        }
+    }
+
+    // Starts timer A (tb = false) or B in one-shot mode, with force load.
+    void start(bool tb, unsigned latch, unsigned mask)
+    {
+        unsigned lo = tb ? 0x6 : 0x4;
+        run({
+            idle & ~pin_mask(RES),
+            access(ICR, false, 0x80 | mask),
+            access(lo, false, latch & 0xFF),
+            access(lo + 1, false, latch >> 8),
+            access(tb ? CRB : CRA, false, 0x19),
+        });
+    }
+
+private:
+    M model;
+};
+
+// Cycles from the start of Timer A to the cycle in which it reads zero, or 0
+// on timeout. The latch value must be below 256.
+template <typename M>
+unsigned underflow_cycle(unsigned latch)
+{
+    Host<M> host;
+    host.start(false, latch, 0x00);
+    for (unsigned n = 1; n < latch + 64; n++) {
+        if (get_port(host.cycle(access(TALO, true, 0)), DB) == 0) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+// Cycles from the start of Timer A to the first ICR read which returns its
+// flag, or 0 on timeout.
+template <typename M>
+unsigned flag_cycle(unsigned latch)
+{
+    for (unsigned n = 1; n < latch + 64; n++) {
+        Host<M> host;
+        host.start(false, latch, 0x00);
+        for (unsigned i = 1; i < n; i++) {
+            host.cycle(idle);
+        }
+        if (get_port(host.cycle(access(ICR, true, 0)), DB) & 0x01) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+// Cycles from the start of Timer A to IRQ going low, or 0 on timeout.
+template <typename M>
+unsigned irq_latency(unsigned latch)
+{
+    Host<M> host;
+    host.start(false, latch, 0x01);
+    for (unsigned n = 1; n < latch + 64; n++) {
+        if (!get_pin(host.cycle(idle), IRQ)) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+// Number of ICR read positions, from 0 to span cycles after the start of the
+// timer, for which the underflow is not seen by this or a later read.
+template <typename M>
+unsigned lost_interrupts(bool tb, unsigned latch, unsigned span)
+{
+    const unsigned bit = tb ? 0x02 : 0x01;
+    unsigned lost = 0;
+
+    for (unsigned k = 0; k <= span; k++) {
+        Host<M> host;
+        host.start(tb, latch, 0x00);
+        for (unsigned i = 0; i < k; i++) {
+            host.cycle(idle);
+        }
+        unsigned first = get_port(host.cycle(access(ICR, true, 0)), DB);
+        for (unsigned i = 0; i < 8; i++) {
+            host.cycle(idle);
+        }
+        unsigned second = get_port(host.cycle(access(ICR, true, 0)), DB);
+        if (!((first | second) & bit)) {
+            lost++;
+        }
+    }
+    return lost;
+}
+
+// Cycles from an ICR read acknowledging the Timer A interrupt to IRQ going
+// high, or 0 on timeout.
+template <typename M>
+unsigned irq_release(unsigned latch)
+{
+    Host<M> host;
+    host.start(false, latch, 0x01);
+    for (unsigned n = 0; n < latch + 64; n++) {
+        if (!get_pin(host.cycle(idle), IRQ)) {
+            break;
+        }
+    }
+    host.cycle(idle);
+    host.cycle(access(ICR, true, 0));
+    for (unsigned n = 1; n < 16; n++) {
+        if (get_pin(host.cycle(idle), IRQ)) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+struct Races {
+    unsigned held = 0;
+    unsigned spurious = 0;
+};
+
+// ICR read positions, from 0 to span cycles after the start of the timer with
+// its interrupt enabled, for which IRQ is held or spurious.
+template <typename M>
+Races read_races(bool tb, unsigned latch, unsigned span)
+{
+    const unsigned bit = tb ? 0x02 : 0x01;
+    Races races;
+
+    for (unsigned k = 0; k <= span; k++) {
+        Host<M> host;
+        host.start(tb, latch, bit);
+        for (unsigned i = 0; i < k; i++) {
+            host.cycle(idle);
+        }
+        unsigned first = get_port(host.cycle(access(ICR, true, 0)), DB);
+        if (!get_pin(host.cycle(idle), IRQ)) {
+            races.held++;
+        }
+        bool again = false;
+        for (unsigned i = 0; i < 8; i++) {
+            again |= !get_pin(host.cycle(idle), IRQ);
+        }
+        if ((first & bit) && again) {
+            races.spurious++;
+        }
+    }
+    return races;
+}
+
+// Cycles of a pseudo random bus program for which the two models give
+// different pin levels.
+template <typename A, typename B>
+unsigned mismatches(size_t n)
+{
+    std::vector<PinWord> in;
+    in.push_back(idle & ~pin_mask(RES));
+    uint32_t x = 1;
+    while (in.size() < n) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        PinWord w = x & 1 ? access(x >> 1 & 0xF, x & 0x20, x >> 8) : idle;
+        w = (w & ~(port_mask(PA, 0xFF) | port_mask(PB, 0xFF))) |
+            port_mask(PA, x >> 16) | port_mask(PB, x >> 24);
+        w = set_pin(w, FLAG, x >> 6 & 1);
+        w = set_pin(w, TOD, x >> 7 & 1);
+        w = set_pin(w, CNT, x >> 13 & 1);
+        w = set_pin(w, SP, x >> 14 & 1);
+        in.push_back(w);
+    }
+
+    std::vector<PinWord> out_a(n);
+    std::vector<PinWord> out_b(n);
+    A a;
+    B b;
+    a.load(in.data(), out_a.data(), n);
+    a.step(n);
+    b.load(in.data(), out_b.data(), n);
+    b.step(n);
+
+    unsigned count = 0;
+    for (size_t i = 0; i < n; i++) {
+        count += out_a[i] != out_b[i];
+    }
+    return count;
+}
+
+struct TodEvents {
+    unsigned count = 0;
+    unsigned latched = 0;
+    unsigned reg_b = 0xFF;
+};
+
+// 8520 event counter after n one cycle TOD pulses. latched is the count read
+// back after a read of register A and n more pulses.
+TodEvents tod_events(unsigned n)
+{
+    Host<Cia8520Model> host;
+    TodEvents tod;
+
+    host.run({
+        idle & ~pin_mask(RES),
+        access(CRB, false, 0x00),
+        access(TODM, false, 0x00),
+        access(TODS, false, 0x00),
+        access(TOD10, false, 0x00),
+    });
+
+    auto pulses = [&](unsigned k) {
+        for (unsigned i = 0; i < k; i++) {
+            host.cycle(set_pin(idle, TOD, 1));
+            for (unsigned j = 0; j < 3; j++) {
+                host.cycle(set_pin(idle, TOD, 0));
+            }
+        }
+        for (unsigned j = 0; j < 4; j++) {
+            host.cycle(set_pin(idle, TOD, 0));
+        }
+    };
+    auto read = [&](unsigned reg) {
+        return get_port(host.cycle(set_pin(access(reg, true, 0), TOD, 0)), DB);
+    };
+
+    host.cycle(set_pin(idle, TOD, 0));
+    pulses(n);
+    unsigned msb = read(TODM);
+    pulses(n);
+    tod.latched = msb << 16 | read(TODS) << 8 | read(TOD10);
+    msb = read(TODM);
+    tod.count = msb << 16 | read(TODS) << 8 | read(TOD10);
+    tod.reg_b = read(TODH);
+    return tod;
+}
+
+bool check(const char* what, int got, int want)
+{
+    std::printf("%-36s %4d (%d)%s\n", what, got, want, got == want ? "" : "  FAIL");
+    return got == want;
+}
+
+// Interrupt timing, lost interrupts, IRQ release and read races of one
+// variant. irq is set to the cycle of the first IRQ after the timer start.
+template <typename M>
+bool check_variant(const char* name, bool old, unsigned latch, unsigned span, int& irq)
+{
+    char what[64];
+    bool ok = true;
+
+    auto item = [&](const char* s) {
+        std::snprintf(what, sizeof what, "%s %s", name, s);
+        return what;
+    };
+
+    int underflow = underflow_cycle<M>(latch);
+    int flag = flag_cycle<M>(latch);
+    irq = irq_latency<M>(latch);
+    std::printf("%s, latch %u: underflow in cycle %d, ICR flag %d, IRQ %d\n",
+                name, latch, underflow, flag, irq);
+    ok &= check(item("underflow found"), underflow != 0, 1);
+    ok &= check(item("underflow to ICR flag"), flag - underflow, 1);
+    ok &= check(item("underflow to IRQ"), irq - underflow, old ? 2 : 1);
+
+    ok &= check(item("Timer A lost interrupts"), lost_interrupts<M>(false, latch, span), 0);
+    ok &= check(item("Timer B lost interrupts"), lost_interrupts<M>(true, latch, span), old);
+
+    ok &= check(item("IRQ release"), irq_release<M>(latch), 1);
+
+    for (bool tb : { false, true }) {
+        Races races = read_races<M>(tb, latch, span);
+        ok &= check(item(tb ? "Timer B held IRQs" : "Timer A held IRQs"), races.held, 0);
+        ok &= check(item(tb ? "Timer B spurious IRQs" : "Timer A spurious IRQs"),
+                    races.spurious, 0);
+    }
+
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned latch = 16;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "l:")) != -1) {
+        switch (opt) {
+        case 'l':
+            latch = std::strtoul(optarg, nullptr, 0);
+            break;
+        default:
+            std::fprintf(stderr, "usage: cia_errata [-l latch]\n");
+            return 2;
+        }
+    }
+    if (latch < 1 || latch > 255) {
+        std::fprintf(stderr, "cia_errata: latch must be 1 - 255\n");
+        return 2;
+    }
+
+    // The read positions cover the underflow with some margin on both sides.
+    const unsigned span = latch + 8;
+    bool ok = true;
+    int irq, irq_old, irq_8520, irq_mac16;
+
+    ok &= check_variant<CiaModel>("6526A", false, latch, span, irq);
+    ok &= check_variant<Cia6526Model>("6526", true, latch, span, irq_old);
+    ok &= check_variant<Cia8520Model>("8520", false, latch, span, irq_8520);
+    ok &= check_variant<CiaMac16Model>("6526A MAC16", false, latch, span, irq_mac16);
+
+    ok &= check("6526 IRQ - 6526A IRQ", irq_old - irq, 1);
+    ok &= check("8520 IRQ - 6526A IRQ", irq_8520 - irq, 0);
+    ok &= check("6526A MAC16 IRQ - 6526A IRQ", irq_mac16 - irq, 0);
+    ok &= check("6526A MAC16 / 6526A mismatched cycles",
+                mismatches<CiaModel, CiaMac16Model>(1 << 20), 0);
+
+    const unsigned pulses = 300;
+    TodEvents tod = tod_events(pulses);
+    ok &= check("8520 TOD events", tod.count, 2*pulses);
+    ok &= check("8520 TOD latched events", tod.latched, pulses);
+    ok &= check("8520 TOD register B", tod.reg_b, 0);
+
+    return !ok;
+}
@@ -0,0 +1,167 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#include "cia_model.h"
+#include "cia_pins.h"
+
+#include "Vcia.h"
+#include "Vcia6526.h"
+#include "Vcia8520.h"
+#include "Vcia_mac16.h"
+#include "verilated.h"
+
+#include <algorithm>
+
+using namespace cia_pins;
+
+namespace {
+
+// Fields of the CIA core inputs.
+enum : unsigned {
+    I_DB   = 0,   // 8 bits
+    I_PA   = 8,   // 8 bits
+    I_PB   = 16,  // 8 bits
+    I_RS   = 24,  // 4 bits
+    I_RES  = 28,
+    I_CS   = 29,
+    I_R_W  = 30,
+    I_FLAG = 31,
+    I_TOD  = 32,
+    I_CNT  = 33,
+    I_SP   = 34,
+};
+
+// Fields of the CIA core outputs.
+enum : unsigned {
+    O_DB  = 0,    // 8 bits
+    O_PA  = 8,    // 8 bits
+    O_PB  = 16,   // 8 bits
+    O_PC  = 24,
+    O_CNT = 25,
+    O_SP  = 26,
+    O_IRQ = 27,
+};
+
+constexpr unsigned DB[8] = { DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7 };
+constexpr unsigned PA[8] = { PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7 };
+constexpr unsigned PB[8] = { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+
+struct PinMap {
+    PinGather gather;
+    PinScatter scatter;
+
+    PinMap()
+    {
+        for (unsigned i = 0; i < 8; i++) {
+            gather.map(DB[i], I_DB + i);
+            gather.map(PA[i], I_PA + i);
+            gather.map(PB[i], I_PB + i);
+            scatter.map(O_DB + i, DB[i]);
+            scatter.map(O_PA + i, PA[i]);
+            scatter.map(O_PB + i, PB[i]);
+        }
+        gather.map(RS0, I_RS + 0);
+        gather.map(RS1, I_RS + 1);
+        gather.map(RS2, I_RS + 2);
+        gather.map(RS3, I_RS + 3);
+        gather.map(RES, I_RES);
+        gather.map(CS, I_CS);
+        gather.map(R_W, I_R_W);
+        gather.map(FLAG, I_FLAG);
+        gather.map(TOD, I_TOD);
+        gather.map(CNT, I_CNT);
+        gather.map(SP, I_SP);
+        scatter.map(O_PC, PC);
+        scatter.map(O_CNT, CNT);
+        scatter.map(O_SP, SP);
+        scatter.map(O_IRQ, IRQ);
+    }
+};
+
+const PinMap pin_map;
+
+}  // namespace
+
+template <typename V>
+CiaCoreModel<V>::CiaCoreModel() :
+    context(std::make_unique<VerilatedContext>()),
+    top(std::make_unique<V>(context.get()))
+{
+    top->phi2 = 0;
+    top->res_n = 0;
+    top->cs_n = 1;
+    top->r_w = 1;
+    top->timer_tick = 1;
+    top->eval();
+}
+
+template <typename V>
+CiaCoreModel<V>::~CiaCoreModel()
+{
+    top->final();
+}
+
+template <typename V>
+size_t CiaCoreModel<V>::step(size_t n)
+{
+    V& m = *top;
+
+    n = std::min(n, len - pos);
+
+    const PinWord* p = in + pos;
+    PinWord* q = out + pos;
+
+    for (const PinWord* end = p + n; p != end; p++, q++) {
+        PinWord w = *p;
+        uint64_t f = pin_map.gather(w);
+
+        // Ports and open drain lines read back the resolved pin levels. The
+        // outputs only change on the falling edge of PHI2, so the levels
+        // resulting from the previous cycle are valid for the whole cycle.
+        unsigned pa = f >> I_PA & 0xFF;
+        unsigned pb = f >> I_PB & 0xFF;
+
+        m.res_n  = f >> I_RES & 1;
+        m.cs_n   = f >> I_CS & 1;
+        m.r_w    = f >> I_R_W & 1;
+        m.rs     = f >> I_RS & 0xF;
+        m.db_i   = f >> I_DB & 0xFF;
+        m.pa_i   = (pa & ~m.pa_oe) | (m.pa_o & m.pa_oe);
+        m.pb_i   = (pb & ~m.pb_oe) | (m.pb_o & m.pb_oe);
+        m.flag_n = f >> I_FLAG & 1;
+        m.tod    = f >> I_TOD & 1;
+        m.cnt_i  = (f >> I_CNT & 1) & !m.cnt_oe;
+        m.sp_i   = (f >> I_SP & 1) & !m.sp_oe;
+
+        // PHI2 high: read data is driven.
+        m.phi2 = 1;
+        m.eval();
+
+        // Outputs are applied to the external pin levels. PC is push-pull,
+        // CNT, SP and IRQ are open drain.
+        uint32_t o = m.db_o << O_DB | m.pa_o << O_PA | m.pb_o << O_PB |
+                     m.pc_n << O_PC;
+        uint32_t oe = (m.db_oe ? 0xFF << O_DB : 0) | m.pa_oe << O_PA |
+                      m.pb_oe << O_PB | 1 << O_PC | m.cnt_oe << O_CNT |
+                      m.sp_oe << O_SP | !m.irq_n << O_IRQ;
+        *q = (w & ~pin_map.scatter(oe)) | pin_map.scatter(o & oe);
+
+        // PHI2 low: registers are updated.
+        m.phi2 = 0;
+        m.eval();
+    }
+
+    pos += n;
+    ncycles += n;
+
+    return n;
+}
+
+template class CiaCoreModel<Vcia>;
+template class CiaCoreModel<Vcia6526>;
+template class CiaCoreModel<Vcia8520>;
+template class CiaCoreModel<Vcia_mac16>;
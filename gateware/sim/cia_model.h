@@ -0,0 +1,48 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "model.h"
+
+#include <memory>
+
+class VerilatedContext;
+class Vcia;
+class Vcia6526;
+class Vcia8520;
+class Vcia_mac16;
+
+// Model of the CIA core, built by Verilator. Pin names are as in
+// redip-cia.pcf. V is the verilated core: Vcia with the default 6526A
+// behaviour, Vcia6526 and Vcia8520 built with the core parameters of
+// CIA_MODEL=6526 and 8520, or Vcia_mac16 built with TIMER_MAC16=1 and the
+// SB_MAC16 simulation model of yosys, see cia.sv. CIA_MODEL=8521 builds the
+// 6526A logic, so its model is Vcia.
+template <typename V>
+class CiaCoreModel : public Model {
+public:
+    CiaCoreModel();
+    ~CiaCoreModel() override;
+
+    size_t step(size_t n) override;
+
+private:
+    std::unique_ptr<VerilatedContext> context;
+    std::unique_ptr<V> top;
+};
+
+using CiaModel = CiaCoreModel<Vcia>;
+using Cia6526Model = CiaCoreModel<Vcia6526>;
+using Cia8520Model = CiaCoreModel<Vcia8520>;
+using Cia8521Model = CiaModel;
+using CiaMac16Model = CiaCoreModel<Vcia_mac16>;
+
+extern template class CiaCoreModel<Vcia>;
+extern template class CiaCoreModel<Vcia6526>;
+extern template class CiaCoreModel<Vcia8520>;
+extern template class CiaCoreModel<Vcia_mac16>;
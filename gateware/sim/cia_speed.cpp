@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+// Simulation speed of the CIA model, in PHI2 cycles per second.
+//
+// usage: cia_speed [million cycles]
+//
+// The bus program resembles a C64 KERNAL setup: Timer A runs continuously
+// with IRQ enabled, and the ICR is read by the interrupt handler.
+
+#include "cia_model.h"
+#include "cia_pins.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace cia_pins;
+
+static constexpr unsigned PA[8] = { PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7 };
+static constexpr unsigned PB[8] = { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+static constexpr unsigned DB[8] = { DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7 };
+
+// Idle bus: chip deselected, pulled up inputs high.
+static constexpr PinWord idle =
+    pin_mask(RES) | pin_mask(CS) | pin_mask(R_W) | pin_mask(FLAG) |
+    pin_mask(CNT) | pin_mask(SP) | pin_mask(IRQ) |
+    port_mask(PA, 0xFF) | port_mask(PB, 0xFF);
+
+static PinWord access(unsigned reg, bool read, unsigned data)
+{
+    PinWord w = idle & ~pin_mask(CS);
+    w = set_pin(w, R_W, read);
+    w = set_pin(w, RS0, reg);
+    w = set_pin(w, RS1, reg >> 1);
+    w = set_pin(w, RS2, reg >> 2);
+    w = set_pin(w, RS3, reg >> 3);
+    return read ? w : (w & ~port_mask(DB, 0xFF)) | port_mask(DB, data);
+}
+
+int main(int argc, char** argv)
+{
+    size_t mcycles = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 100;
+
+    // One second of PAL C64 bus activity.
+    std::vector<PinWord> in;
+    in.push_back(idle & ~pin_mask(RES));
+    in.push_back(access(0x4, false, 0x25));  // Timer A latch $4025
+    in.push_back(access(0x5, false, 0x40));
+    in.push_back(access(0xD, false, 0x81));  // Enable Timer A IRQ
+    in.push_back(access(0xE, false, 0x11));  // Start continuous, force load
+    while (in.size() < 985248) {
+        for (int i = 0; i < 64; i++) {
+            in.push_back(idle);
+        }
+        in.push_back(access(0x1, true, 0));  // Keyboard scan
+        in.push_back(access(0xD, true, 0));  // Acknowledge IRQ
+    }
+    std::vector<PinWord> out(in.size());
+
+    CiaModel model;
+
+    auto t0 = std::chrono::steady_clock::now();
+    while (model.cycles() < mcycles*1000000) {
+        model.load(in.data(), out.data(), in.size());
+        while (model.step(in.size())) {}
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double s = std::chrono::duration<double>(t1 - t0).count();
+    std::printf("%llu cycles in %.3f s: %.2f M cycles/s\n",
+                (unsigned long long)model.cycles(), s, model.cycles()/s/1e6);
+
+    return 0;
+}
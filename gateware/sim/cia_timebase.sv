@@ -0,0 +1,66 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// CIA core with its timer clock from redip_timebase.sv, connected as in
+// redip_cia.sv, for sim/timebase_check.cpp. The oscillator reference
+// (SOURCE = 2) needs SB_HFOSC, and is not simulated.
+module cia_timebase #(
+    parameter SOURCE = 1
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       cs_n,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    input  logic       cnt_i,
+    input  logic       tod,
+    output logic       irq_n
+);
+
+    logic timer_tick;
+
+    redip_timebase #(
+        .SOURCE (SOURCE)
+    ) timebase (
+        .phi2 (phi2),
+        .cnt  (cnt_i),
+        .tick (timer_tick)
+    );
+
+    cia core (
+        .phi2        (phi2),
+        .res_n       (res_n),
+        .cs_n        (cs_n),
+        .r_w         (r_w),
+        .rs          (rs),
+        .db_i        (db_i),
+        .db_o        (db_o),
+        .db_oe       (db_oe),
+        .pa_i        (8'hFF),
+        .pa_o        (),
+        .pa_oe       (),
+        .pb_i        (8'hFF),
+        .pb_o        (),
+        .pb_oe       (),
+        .pc_n        (),
+        .flag_n      (1'b1),
+        .tod         (tod),
+        .timer_tick  (timer_tick),
+        .cnt_i       (cnt_i),
+        .cnt_oe      (),
+        .sp_i        (1'b1),
+        .sp_oe       (),
+        .irq_n       (irq_n),
+        .timer_event ()
+    );
+
+endmodule
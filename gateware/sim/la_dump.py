@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+# This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+# MOS 6526/8520/8521 CIA FPGA replacement.
+#
+# Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+# ----------------------------------------------------------------------------
+
+"""Decode a bus logic analyzer dump, see redip_la.sv.
+
+usage: la_dump.py [-p post] [-t trace -c file.pcf] <dump>
+
+A dump is the byte stream read from the logic analyzer window, oldest sample
+first, 4 bytes per PHI2 cycle. Prints one line per cycle, numbered relative
+to the trigger sample, which is post samples before the end.
+
+With -t, also writes the samples as a trace for trace_replay, with the pin
+numbers taken from the personality PCF. Pins which are not sampled are set
+high, as by their pull-ups, so a replay only matches if they were idle. To
+start the model in a known state, trigger on RES, e.g. with mask 00008000h
+and value 00000000h.
+"""
+
+import getopt
+import struct
+import sys
+
+# set_io options which take a value.
+VALUE_OPTIONS = {"-pullup", "-pullup_resistor"}
+
+
+def read_pcf(pcf):
+    pins = {}
+    with open(pcf) as f:
+        for line in f:
+            words = line.split("#", 1)[0].split()
+            if not words or words[0] != "set_io":
+                continue
+            args = []
+            it = iter(words[1:])
+            for w in it:
+                if w in VALUE_OPTIONS:
+                    next(it, None)
+                elif not w.startswith("-"):
+                    args.append(w)
+            pins[args[0]] = int(args[1])
+    return pins
+
+
+def fields(s):
+    return {
+        "db": s & 0xFF,
+        "rs": s >> 8 & 0xF,
+        "r_w": s >> 12 & 1,
+        "sel": s >> 13 & 1,
+        "irq": s >> 14 & 1,
+        "res": s >> 15 & 1,
+        "pa": s >> 16 & 0xFF,
+        "pb": s >> 24 & 0xFF,
+    }
+
+
+def pin_word(pins, f):
+    levels = {}
+    for name in pins:
+        levels[name] = 1
+    for i in range(8):
+        levels[f"DB{i}"] = f["db"] >> i & 1
+        levels[f"PA{i}"] = f["pa"] >> i & 1
+        levels[f"PB{i}"] = f["pb"] >> i & 1
+    for i in range(4):
+        levels[f"RS{i}"] = f["rs"] >> i & 1
+    levels["R_W"] = f["r_w"]
+    levels["RES"] = f["res"]
+    for irq in ("IRQ", "IRQA", "IRQB"):
+        levels[irq] = f["irq"]
+    # Chip select inputs at their active levels, see bus_io.sv.
+    for cs in ("CS", "CS2"):
+        levels[cs] = 1 - f["sel"]
+    for cs in ("CS0", "CS1"):
+        levels[cs] = f["sel"]
+    w = 0
+    for name, pin in pins.items():
+        w |= levels.get(name, 1) << pin
+    return w
+
+
+def main(argv):
+    try:
+        opts, args = getopt.getopt(argv[1:], "p:t:c:")
+    except getopt.GetoptError:
+        opts, args = [], []
+    opts = dict(opts)
+    if len(args) != 1 or ("-t" in opts) != ("-c" in opts):
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 2
+
+    post = int(opts.get("-p", "0"), 0)
+
+    with open(args[0], "rb") as f:
+        data = f.read()
+    samples = [s for (s,) in struct.iter_unpack("<I", data[:len(data)//4*4])]
+    trigger = len(samples) - 1 - post
+
+    print("cycle   sel r/w rs db  irq res pa pb")
+    for i, s in enumerate(samples):
+        f = fields(s)
+        access = ("R" if f["r_w"] else "W") if f["sel"] else "-"
+        print(f"{i - trigger:6d}  {f['sel']:3d} {access:>3} {f['rs']:2x} {f['db']:02x}"
+              f"  {f['irq']:3d} {f['res']:3d} {f['pa']:02x} {f['pb']:02x}"
+              f"{'  <- trigger' if i == trigger else ''}")
+
+    if "-t" in opts:
+        pins = read_pcf(opts["-c"])
+        with open(opts["-t"], "wb") as f:
+            for s in samples:
+                f.write(struct.pack("<Q", pin_word(pins, fields(s))))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
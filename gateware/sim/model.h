@@ -0,0 +1,47 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pins.h"
+
+#include <cstddef>
+
+// Cycle accurate model of one of the gateware cores.
+//
+// Bus transactions are preloaded as one PinWord per PHI2 cycle, holding the
+// pin levels driven onto the chip from outside (address, control and write
+// data, and the external levels of ports and open drain lines). step() then
+// runs a batch of cycles without any per cycle callback, writing the pin
+// levels with the chip's outputs applied.
+class Model {
+public:
+    virtual ~Model() = default;
+
+    // Load n cycles of input vectors, and the buffer for n output vectors.
+    void load(const PinWord* in, PinWord* out, size_t n)
+    {
+        this->in = in;
+        this->out = out;
+        len = n;
+        pos = 0;
+    }
+
+    // Run up to n PHI2 cycles of the loaded vectors, returning the number of
+    // cycles run.
+    virtual size_t step(size_t n) = 0;
+
+    // Total number of PHI2 cycles run.
+    uint64_t cycles() const { return ncycles; }
+
+protected:
+    const PinWord* in = nullptr;
+    PinWord* out = nullptr;
+    size_t len = 0;
+    size_t pos = 0;
+    uint64_t ncycles = 0;
+};
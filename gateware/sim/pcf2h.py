@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+# This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+# MOS 6526/8520/8521 CIA FPGA replacement.
+#
+# Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+# ----------------------------------------------------------------------------
+
+"""Generate a C++ header of package pin numbers from a PCF file.
+
+usage: pcf2h.py <namespace> <file.pcf> <file.h>
+
+Each set_io constraint becomes a constant named as the signal, with the
+package pin number as value. The simulation models use the pin number as bit
+position in a 64 bit word of pin levels.
+"""
+
+import sys
+
+# set_io options which take a value.
+VALUE_OPTIONS = {"-pullup", "-pullup_resistor"}
+
+
+def main(argv):
+    if len(argv) != 4:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 2
+
+    ns, pcf, header = argv[1:]
+
+    pins = []
+    with open(pcf) as f:
+        for line in f:
+            words = line.split("#", 1)[0].split()
+            if not words or words[0] != "set_io":
+                continue
+            args = []
+            it = iter(words[1:])
+            for w in it:
+                if w in VALUE_OPTIONS:
+                    next(it, None)
+                elif not w.startswith("-"):
+                    args.append(w)
+            pins.append((args[0], int(args[1])))
+
+    with open(header, "w") as f:
+        f.write(f"// Generated from {pcf} by pcf2h.py, do not edit.\n\n")
+        f.write("#pragma once\n\n")
+        f.write(f"namespace {ns} {{\n\n")
+        f.write("enum Pin : unsigned {\n")
+        for name, pin in pins:
+            f.write(f"    {name:4} = {pin},\n")
+        f.write("};\n\n")
+        f.write("constexpr struct { const char* name; Pin pin; } pins[] = {\n")
+        for name, pin in pins:
+            f.write(f"    {{ \"{name}\", {name} }},\n")
+        f.write("};\n\n")
+        f.write(f"}}  // namespace {ns}\n")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,97 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+// Levels of iCE5LP1K-SG48 package pins 1 - 48 during one PHI2 cycle, with bit
+// n holding the level of package pin n. Signal names and pin numbers are
+// generated from the PCF files, see pcf2h.py.
+using PinWord = uint64_t;
+
+constexpr PinWord pin_mask(unsigned pin)
+{
+    return PinWord(1) << pin;
+}
+
+constexpr unsigned get_pin(PinWord w, unsigned pin)
+{
+    return (w >> pin) & 1;
+}
+
+constexpr PinWord set_pin(PinWord w, unsigned pin, unsigned level)
+{
+    return (w & ~pin_mask(pin)) | (PinWord(level & 1) << pin);
+}
+
+// Gather / scatter an 8 bit port, with pins given LSB first.
+constexpr unsigned get_port(PinWord w, const unsigned (&pins)[8])
+{
+    unsigned v = 0;
+    for (unsigned i = 0; i < 8; i++) {
+        v |= get_pin(w, pins[i]) << i;
+    }
+    return v;
+}
+
+constexpr PinWord port_mask(const unsigned (&pins)[8], unsigned v)
+{
+    PinWord m = 0;
+    for (unsigned i = 0; i < 8; i++) {
+        m |= PinWord((v >> i) & 1) << pins[i];
+    }
+    return m;
+}
+
+// Table driven gather of package pins into the bits of a field word, one
+// table lookup per byte of the PinWord.
+class PinGather {
+public:
+    void map(unsigned pin, unsigned bit)
+    {
+        for (unsigned v = 0; v < 256; v++) {
+            if ((v >> (pin & 7)) & 1) {
+                table[pin >> 3][v] |= uint64_t(1) << bit;
+            }
+        }
+    }
+
+    uint64_t operator()(PinWord w) const
+    {
+        uint64_t f = 0;
+        for (unsigned i = 0; i < 7; i++) {
+            f |= table[i][(w >> 8*i) & 0xFF];
+        }
+        return f;
+    }
+
+private:
+    uint64_t table[7][256] = {};
+};
+
+// Table driven scatter of the bits of a 32 bit field word onto package pins.
+class PinScatter {
+public:
+    void map(unsigned bit, unsigned pin)
+    {
+        for (unsigned v = 0; v < 256; v++) {
+            if ((v >> (bit & 7)) & 1) {
+                table[bit >> 3][v] |= pin_mask(pin);
+            }
+        }
+    }
+
+    PinWord operator()(uint32_t f) const
+    {
+        return table[0][f & 0xFF] | table[1][(f >> 8) & 0xFF] |
+               table[2][(f >> 16) & 0xFF] | table[3][f >> 24];
+    }
+
+private:
+    PinWord table[4][256] = {};
+};
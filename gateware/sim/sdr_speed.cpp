@@ -0,0 +1,373 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+// Sustained serial data register throughput and timing of the CIA model.
+//
+// usage: sdr_speed [-i] [-l latch] [-d delay] [-n bytes]
+//
+// Output mode (default): Timer A runs continuously with the given latch
+// value, or in turn with latch 0, which gives the theoretical maximum bit
+// rate of PHI2/2, and latch 1. The host keeps the serial data register
+// full: the second byte is written as soon as the first has been
+// transferred to the shift register, and one more is written delay cycles
+// after each SP interrupt. The bytes on SP are decoded on the rising edges
+// of CNT.
+//
+// Input mode (-i): CNT is toggled externally every cycle, i.e. at PHI2/2
+// bits per second, with SP changing while CNT is low. The host reads the
+// serial data register delay cycles after each SP interrupt.
+//
+// The received bytes are checked against the sent bytes, and the timing is
+// checked against that described in cia_sdr.sv:
+//
+// - Output mode: CNT toggles once per Timer A period, latch + 1 cycles,
+//   through the last bit of a byte, and on to the first bit of the next
+//   byte if that was written before the rising CNT edge of the last bit.
+//   SP only changes together with a falling CNT edge.
+// - IRQ is low from the cycle after the one in which CNT reads high for the
+//   last bit in output mode, and from the third cycle after the one in
+//   which CNT is driven high for the last bit in input mode, where CNT is
+//   synchronized first. If ICR is read in the cycle before, IRQ is low one
+//   cycle later, see cia.sv. IRQ must not go low in any other cycle.
+//
+// The sustained rate is reported in cycles per byte and in bytes per second
+// of PAL C64 PHI2 (985248Hz), together with the simulation speed. The exit
+// status is 1 if any byte or timing check fails.
+
+#include "cia_model.h"
+#include "cia_pins.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace cia_pins;
+
+namespace {
+
+constexpr unsigned DB[8] = { DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7 };
+
+constexpr double PHI2_HZ = 985248;
+
+// Idle bus: chip deselected, pulled up inputs high.
+constexpr PinWord idle =
+    pin_mask(RES) | pin_mask(CS) | pin_mask(R_W) | pin_mask(FLAG) |
+    pin_mask(CNT) | pin_mask(SP) | pin_mask(IRQ);
+
+constexpr unsigned SDR = 0xC;
+constexpr unsigned ICR = 0xD;
+
+PinWord access(unsigned reg, bool read, unsigned data)
+{
+    PinWord w = idle & ~pin_mask(CS);
+    w = set_pin(w, R_W, read);
+    w = set_pin(w, RS0, reg);
+    w = set_pin(w, RS1, reg >> 1);
+    w = set_pin(w, RS2, reg >> 2);
+    w = set_pin(w, RS3, reg >> 3);
+    return read ? w : w | port_mask(DB, data);
+}
+
+// Whether w is an access to reg.
+bool is_access(PinWord w, unsigned reg, bool read)
+{
+    return !get_pin(w, CS) && get_pin(w, R_W) == read &&
+           get_pin(w, RS0) == (reg & 1) && get_pin(w, RS1) == (reg >> 1 & 1) &&
+           get_pin(w, RS2) == (reg >> 2 & 1) && get_pin(w, RS3) == (reg >> 3 & 1);
+}
+
+// Test pattern.
+unsigned pattern(size_t i)
+{
+    return (i*0x9D + (i >> 8)) & 0xFF;
+}
+
+// Runs the model one cycle at a time, so that the host can react to IRQ.
+class Host {
+public:
+    PinWord cycle(PinWord w)
+    {
+        PinWord o;
+        model.load(&w, &o, 1);
+        model.step(1);
+        return o;
+    }
+
+    void run(const std::vector<PinWord>& program)
+    {
+        for (PinWord w : program) {
+            cycle(w);
+        }
+    }
+
+    uint64_t cycles() const { return model.cycles(); }
+
+private:
+    CiaModel model;
+};
+
+// Checks of the cycles in which IRQ goes low, see above.
+class IrqTiming {
+public:
+    // IRQ is due to go low in cycle c.
+    void expect(uint64_t c) { due = c; }
+
+    // Checks the IRQ level of cycle c, with w the bus access of the cycle.
+    // Returns false on a mismatch.
+    bool check(uint64_t c, PinWord w, PinWord o)
+    {
+        bool low = !get_pin(o, IRQ);
+        bool ok = !(c == due && !low) && !(low && !was_low && c != due);
+        if (is_access(w, ICR, true) && c + 1 == due) {
+            due++;
+        }
+        was_low = low;
+        return ok;
+    }
+
+private:
+    uint64_t due = ~uint64_t(0);
+    bool was_low = false;
+};
+
+struct Result {
+    size_t received = 0;
+    long long errors = 0;
+    long long timing = 0;
+};
+
+void timing_error(Result& r, uint64_t c, const char* what)
+{
+    if (r.timing++ < 10) {
+        std::printf("cycle %llu: %s\n", (unsigned long long)c, what);
+    }
+}
+
+// Sends nbytes bytes through the serial data register in output mode.
+Result output(unsigned latch, unsigned delay, size_t nbytes, uint64_t& first, uint64_t& last,
+              Host& host)
+{
+    Result r;
+    std::deque<PinWord> pending;
+    IrqTiming irq;
+    size_t sent = 0;
+    unsigned shift = 0;
+    unsigned bits = 0;
+    unsigned cnt = 1;
+    unsigned sp = 1;
+    uint64_t edge = 0;     // Cycle of the last CNT edge, 0 for none
+    bool queued = false;   // A byte has been written and not yet started
+    bool follows = false;  // The next byte follows without a gap
+
+    // Give up when no byte has been received for several byte times.
+    const uint64_t timeout = 64*(latch + 1) + delay + 64;
+    last = host.cycles();
+
+    pending.push_back(access(SDR, false, pattern(sent++)));
+
+    while (r.received < nbytes && host.cycles() - last < timeout) {
+        PinWord w = idle;
+        if (!pending.empty()) {
+            w = pending.front();
+            pending.pop_front();
+        }
+        uint64_t c = host.cycles();
+        PinWord o = host.cycle(w);
+        bool rise = get_pin(o, CNT) && !cnt;
+        bool fall = !get_pin(o, CNT) && cnt;
+
+        // Bit timing: one CNT edge per Timer A period within a byte, and
+        // from the last bit of a byte to the next if that was queued.
+        if ((rise || fall) && edge != 0 && (rise || bits != 0 || follows) &&
+            c - edge != latch + 1)
+        {
+            timing_error(r, c, fall && bits == 0 ? "gap between bytes" : "CNT edge");
+        }
+        if (get_pin(o, SP) != sp && !fall) {
+            timing_error(r, c, "SP change without falling CNT edge");
+        }
+
+        // The receiver samples SP on the rising edge of CNT.
+        if (rise) {
+            shift = (shift << 1 | get_pin(o, SP)) & 0xFF;
+            if (++bits == 8) {
+                if (shift != pattern(r.received) && r.errors++ < 10) {
+                    std::printf("byte %zu: %02x (%02x)\n", r.received, shift,
+                                pattern(r.received));
+                }
+                if (r.received++ == 0) {
+                    first = host.cycles();
+                }
+                last = host.cycles();
+                bits = 0;
+                follows = queued;
+                irq.expect(c + 1);
+            }
+        }
+        if (!irq.check(c, w, o)) {
+            timing_error(r, c, "IRQ");
+        }
+        if (fall && bits == 0) {
+            queued = false;
+        }
+        // The first byte has been transferred on the first falling edge.
+        if (fall && sent == 1) {
+            pending.push_back(access(SDR, false, pattern(sent++)));
+        }
+        if (rise || fall) {
+            edge = c;
+        }
+        cnt = get_pin(o, CNT);
+        sp = get_pin(o, SP);
+        if (is_access(w, SDR, false)) {
+            queued = true;
+        }
+
+        // Interrupt handler: acknowledge, and write the next byte.
+        if (!get_pin(o, IRQ) && pending.empty()) {
+            pending.insert(pending.end(), delay, idle);
+            pending.push_back(access(ICR, true, 0));
+            if (sent < nbytes) {
+                pending.push_back(access(SDR, false, pattern(sent++)));
+            }
+        }
+    }
+
+    return r;
+}
+
+// Receives nbytes bytes through the serial data register in input mode.
+Result input(unsigned latch, unsigned delay, size_t nbytes, uint64_t& first, uint64_t& last,
+             Host& host)
+{
+    Result r;
+    std::deque<PinWord> pending;
+    IrqTiming irq;
+    uint64_t start = host.cycles();
+
+    const uint64_t timeout = 64*(latch + 1) + delay + 64;
+    last = host.cycles();
+
+    while (r.received < nbytes && host.cycles() - last < timeout) {
+        // CNT is low in even and high in odd cycles, so each bit takes
+        // two cycles, and SP is set up while CNT is low.
+        uint64_t c = host.cycles();
+        uint64_t b = c - start;
+        unsigned cnt = b & 1;
+        unsigned sp = pattern(b/16) >> (7 - b/2 % 8) & 1;
+
+        PinWord w = idle;
+        if (!pending.empty()) {
+            w = pending.front();
+            pending.pop_front();
+        }
+        w = set_pin(set_pin(w, CNT, cnt), SP, sp);
+        PinWord o = host.cycle(w);
+
+        if (!irq.check(c, w, o)) {
+            timing_error(r, c, "IRQ");
+        }
+        // CNT high for the last bit of a byte.
+        if (b % 16 == 15) {
+            irq.expect(c + 3);
+        }
+
+        if (is_access(w, SDR, true)) {
+            unsigned v = get_port(o, DB);
+            if (v != pattern(r.received) && r.errors++ < 10) {
+                std::printf("byte %zu: %02x (%02x)\n", r.received, v, pattern(r.received));
+            }
+            if (r.received++ == 0) {
+                first = host.cycles();
+            }
+            last = host.cycles();
+        }
+
+        // Interrupt handler: acknowledge, and read the byte.
+        if (!get_pin(o, IRQ) && pending.empty()) {
+            pending.insert(pending.end(), delay, idle);
+            pending.push_back(access(ICR, true, 0));
+            pending.push_back(access(SDR, true, 0));
+        }
+    }
+
+    return r;
+}
+
+// Runs one transfer, and prints the results. Returns false if any check fails.
+bool run(bool in, unsigned latch, unsigned delay, size_t nbytes)
+{
+    Host host;
+
+    host.run({
+        idle & ~pin_mask(RES),
+        access(ICR, false, 0x88),                  // Enable SP IRQ
+        access(0x4, false, latch & 0xFF),          // Timer A latch
+        access(0x5, false, latch >> 8),
+        access(0xE, false, in ? 0x11 : 0x51),      // Start continuous, force load
+    });
+
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    Result r = in ? input(latch, delay, nbytes, first, last, host)
+                  : output(latch, delay, nbytes, first, last, host);
+    auto t1 = std::chrono::steady_clock::now();
+    double s = std::chrono::duration<double>(t1 - t0).count();
+
+    double bpc = r.received > 1 ? (r.received - 1)/double(last - first) : 0;
+    std::printf("%s, latch %u, delay %u: %zu bytes, %lld errors, %lld timing errors, "
+                "%.1f cycles/byte, %.0f bytes/s at %.0fHz, %.2f M cycles/s\n",
+                in ? "input" : "output", latch, delay, r.received, r.errors, r.timing,
+                bpc > 0 ? 1/bpc : 0.0, bpc*PHI2_HZ, PHI2_HZ,
+                host.cycles()/s/1e6);
+
+    return r.errors == 0 && r.timing == 0 && r.received == nbytes;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    bool input = false;
+    std::vector<unsigned> latches = { 0, 1 };
+    unsigned delay = 2;
+    size_t nbytes = 100000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "il:d:n:")) != -1) {
+        switch (opt) {
+        case 'i':
+            input = true;
+            break;
+        case 'l':
+            latches = { unsigned(std::strtoul(optarg, nullptr, 0)) };
+            break;
+        case 'd':
+            delay = std::strtoul(optarg, nullptr, 0);
+            break;
+        case 'n':
+            nbytes = std::strtoul(optarg, nullptr, 0);
+            break;
+        default:
+            std::fprintf(stderr, "usage: sdr_speed [-i] [-l latch] [-d delay] [-n bytes]\n");
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    for (unsigned latch : latches) {
+        ok &= run(input, latch, delay, nbytes);
+    }
+
+    return !ok;
+}
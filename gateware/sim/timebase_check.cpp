@@ -0,0 +1,272 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+// Checks of the timer time base with CNT as the reference, see
+// redip_timebase.sv, against stretched and gated PHI2.
+//
+// usage: timebase_check
+//
+// The CIA core and the time base are driven directly rather than through
+// Model, since a stretched PHI2 cycle spans many reference edges. A 1MHz
+// reference runs on CNT, and PHI2 runs at 4MHz with the PHI2 high or low
+// phase of some cycles stretched, or with PHI2 stopped low for a while.
+// Timer A counts the reference edges from $FFFF. After each pattern, the
+// reference is stopped and PHI2 runs until all counts have been taken, and
+// the decrement of Timer A must equal the number of rising edges on CNT.
+// For a stop beyond the 4095 reference periods the time base can hold,
+// exactly 4096 counts must be lost.
+//
+// TOD: the TOD filter samples at the reference rate, see cia_tod.sv. The
+// clock is started in 60Hz mode, with the reference on CNT and a 15.6kHz
+// square wave on TOD, and must advance by exactly one tenth of a second per
+// six rising TOD edges, i.e. once per filtered edge rather than once per
+// PHI2 cycle of it.
+//
+// Results are printed; the exit status is 1 if any check fails.
+
+#include "Vcia_timebase.h"
+#include "verilated.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+namespace {
+
+constexpr unsigned TALO = 0x4;
+constexpr unsigned TAHI = 0x5;
+constexpr unsigned TOD10 = 0x8;
+constexpr unsigned TODS = 0x9;
+constexpr unsigned TODM = 0xA;
+constexpr unsigned TODH = 0xB;
+constexpr unsigned CRA  = 0xE;
+
+// Times in ns.
+constexpr uint64_t PHI2_HALF = 125;
+constexpr uint64_t REF_HALF  = 500;
+constexpr uint64_t TOD_HALF  = 32000;
+
+class Bench {
+public:
+    Bench() :
+        context(std::make_unique<VerilatedContext>()),
+        m(std::make_unique<Vcia_timebase>(context.get()))
+    {
+        m->phi2 = 0;
+        m->res_n = 0;
+        m->cs_n = 1;
+        m->r_w = 1;
+        m->cnt_i = 1;
+        m->tod = 0;
+        m->eval();
+    }
+
+    ~Bench() { m->final(); }
+
+    // Starts or stops the reference; CNT is left high when stopped.
+    void reference(bool on)
+    {
+        if (on && !ref_on) {
+            ref_next = t + REF_HALF;
+        }
+        if (!on && ref_on && !m->cnt_i) {
+            advance(ref_next - t);
+        }
+        ref_on = on;
+    }
+
+    // Starts or stops the TOD signal, which is stopped while low.
+    void tod(bool on)
+    {
+        if (on && !tod_on) {
+            tod_next = t + TOD_HALF;
+        }
+        tod_on = on;
+    }
+
+    bool tod_high() const { return m->tod; }
+
+    // PHI2 stays at its current level for ns.
+    void advance(uint64_t ns)
+    {
+        uint64_t end = t + ns;
+        for (;;) {
+            uint64_t r = ref_on ? ref_next : UINT64_MAX;
+            uint64_t d = tod_on ? tod_next : UINT64_MAX;
+            uint64_t next = std::min(r, d);
+            if (next > end) {
+                break;
+            }
+            t = next;
+            if (next == r) {
+                m->cnt_i = !m->cnt_i;
+                edges += m->cnt_i;
+                ref_next += REF_HALF;
+            }
+            if (next == d) {
+                m->tod = !m->tod;
+                tod_edges += m->tod;
+                tod_next += TOD_HALF;
+            }
+            m->eval();
+        }
+        t = end;
+    }
+
+    // One PHI2 cycle, returning the read data.
+    unsigned cycle(uint64_t high, uint64_t low, bool cs = false, bool read = true,
+                   unsigned reg = 0, unsigned data = 0xFF)
+    {
+        m->cs_n = !cs;
+        m->r_w = read;
+        m->rs = reg;
+        m->db_i = data;
+
+        m->phi2 = 1;
+        m->eval();
+        advance(high);
+        unsigned v = m->db_o;
+
+        m->phi2 = 0;
+        m->eval();
+        advance(low);
+        return v;
+    }
+
+    void idle(unsigned n, uint64_t high = PHI2_HALF, uint64_t low = PHI2_HALF)
+    {
+        for (unsigned i = 0; i < n; i++) {
+            cycle(high, low);
+        }
+    }
+
+    unsigned read(unsigned reg) { return cycle(PHI2_HALF, PHI2_HALF, true, true, reg); }
+    void write(unsigned reg, unsigned v) { cycle(PHI2_HALF, PHI2_HALF, true, false, reg, v); }
+
+    unsigned timer_a() { return read(TALO) | read(TAHI) << 8; }
+
+    // Resets the core and starts Timer A continuously from $FFFF.
+    void start()
+    {
+        idle(4);
+        m->res_n = 1;
+        write(TALO, 0xFF);
+        write(TAHI, 0xFF);
+        write(CRA, 0x11);
+        idle(16);
+    }
+
+    uint64_t edges = 0;
+    uint64_t tod_edges = 0;
+
+private:
+    std::unique_ptr<VerilatedContext> context;
+    std::unique_ptr<Vcia_timebase> m;
+
+    uint64_t t = 0;
+    bool ref_on = false;
+    uint64_t ref_next = 0;
+    bool tod_on = false;
+    uint64_t tod_next = 0;
+};
+
+struct Pattern {
+    const char* name;
+    std::function<void(Bench&)> run;
+    unsigned lost;
+};
+
+// PHI2 cycles with every eighth cycle stretched.
+void stretched(Bench& b, bool high, uint64_t ns)
+{
+    for (unsigned i = 0; i < 4000; i++) {
+        bool s = i % 8 == 7;
+        b.cycle(s && high ? ns : PHI2_HALF, s && !high ? ns : PHI2_HALF);
+    }
+}
+
+// PHI2 stopped low for ns between bursts of cycles.
+void gated(Bench& b, uint64_t ns)
+{
+    b.idle(1000);
+    b.advance(ns);
+    b.idle(8000);
+}
+
+unsigned bcd(unsigned v)
+{
+    return (v >> 4)*10 + (v & 0xF);
+}
+
+// Runs the TOD clock from 1:00:00.0 for 150 rising TOD edges, and returns
+// whether it has advanced by one tenth of a second per six edges.
+bool tod_check()
+{
+    Bench b;
+    b.start();
+    b.write(TODH, 0x01);
+    b.write(TODM, 0x00);
+    b.write(TODS, 0x00);
+    b.write(TOD10, 0x00);
+
+    b.reference(true);
+    b.tod(true);
+    while (b.tod_edges < 150 || b.tod_high()) {
+        b.idle(1);
+    }
+    b.tod(false);
+    b.idle(1000);
+    b.reference(false);
+
+    unsigned hr = b.read(TODH);
+    unsigned tenths = bcd(b.read(TODM))*600 + bcd(b.read(TODS))*10 + bcd(b.read(TOD10));
+    unsigned want = b.tod_edges/6;
+    bool pass = hr == 0x01 && tenths == want;
+    std::printf("%-24s %5llu edges, %5u tenths (%u)%s\n", "TOD 60Hz",
+                (unsigned long long)b.tod_edges, tenths, want, pass ? "" : "  FAIL");
+    return pass;
+}
+
+}  // namespace
+
+int main()
+{
+    const Pattern patterns[] = {
+        { "steady",                  [](Bench& b) { b.idle(4000); },              0 },
+        { "PHI2 low stretched 5us",  [](Bench& b) { stretched(b, false, 5000); }, 0 },
+        { "PHI2 high stretched 5us", [](Bench& b) { stretched(b, true, 5000); },  0 },
+        { "PHI2 stopped 1ms",        [](Bench& b) { gated(b, 1000000); },         0 },
+        { "PHI2 stopped 4ms",        [](Bench& b) { gated(b, 4000000); },         0 },
+        { "PHI2 stopped 5ms",        [](Bench& b) { gated(b, 5000000); },      4096 },
+    };
+
+    bool ok = true;
+
+    for (const Pattern& p : patterns) {
+        Bench b;
+        b.start();
+        unsigned a0 = b.timer_a();
+
+        b.reference(true);
+        p.run(b);
+        b.reference(false);
+        b.idle(8192);
+
+        unsigned got = (a0 - b.timer_a()) & 0xFFFF;
+        unsigned want = b.edges - p.lost;
+        bool pass = got == want;
+        ok &= pass;
+        std::printf("%-24s %5llu edges, %5u counts (%u)%s\n", p.name,
+                    (unsigned long long)b.edges, got, want, pass ? "" : "  FAIL");
+    }
+
+    ok &= tod_check();
+
+    return !ok;
+}
@@ -0,0 +1,202 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+// Replay of recorded bus traces through a core model.
+//
+// usage: trace_replay [-n max] <cia|cia6526|cia8520|cia8521|via|pia> <trace>
+//
+// A trace is a raw array of little endian 64 bit PinWords, one per PHI2
+// cycle, with the levels of all package pins sampled just before the falling
+// edge of PHI2, see pins.h. Traces are memory mapped and fed to the model as
+// is, except that IRQ lines are released, so that the model drives them.
+//
+// The model outputs are compared with the recorded levels on DB0 - DB7, the
+// IRQ line(s), PA0 - PA7 and PB0 - PB7, with the pin list taken from the PCF
+// for the personality. Mismatches (at most max are listed), and simulation
+// speed in PHI2 cycles per second, are reported.
+
+#include "cia_model.h"
+#include "via_model.h"
+#include "pia_model.h"
+#include "cia_pins.h"
+#include "via_pins.h"
+#include "pia_pins.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct PinName {
+    const char* name;
+    unsigned pin;
+};
+
+struct Personality {
+    const char* name;
+    std::vector<PinName> pins;
+    std::unique_ptr<Model> (*make)();
+};
+
+template <typename T>
+std::vector<PinName> pin_names(const T& pins)
+{
+    std::vector<PinName> v;
+    for (const auto& p : pins) {
+        v.push_back({ p.name, p.pin });
+    }
+    return v;
+}
+
+template <typename M>
+std::unique_ptr<Model> make_model()
+{
+    return std::make_unique<M>();
+}
+
+const Personality personalities[] = {
+    { "cia", pin_names(cia_pins::pins), make_model<CiaModel> },
+    { "cia6526", pin_names(cia_pins::pins), make_model<Cia6526Model> },
+    { "cia8520", pin_names(cia_pins::pins), make_model<Cia8520Model> },
+    { "cia8521", pin_names(cia_pins::pins), make_model<Cia8521Model> },
+    { "via", pin_names(via_pins::pins), make_model<ViaModel> },
+    { "pia", pin_names(pia_pins::pins), make_model<PiaModel> },
+};
+
+bool prefix(const char* s, const char* p)
+{
+    return std::strncmp(s, p, std::strlen(p)) == 0;
+}
+
+long long mismatches = 0;
+
+void report(const Personality& pers, uint64_t cycle, PinWord mask, PinWord want, PinWord got)
+{
+    std::printf("cycle %llu:", (unsigned long long)cycle);
+    for (const auto& p : pers.pins) {
+        if (mask & (want ^ got) & pin_mask(p.pin)) {
+            std::printf(" %s=%u (%u)", p.name, get_pin(got, p.pin), get_pin(want, p.pin));
+        }
+    }
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    long long max = 20;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            max = std::strtoll(optarg, nullptr, 0);
+            break;
+        default:
+            return 2;
+        }
+    }
+    if (argc - optind != 2) {
+        std::fprintf(stderr, "usage: trace_replay [-n max] "
+                     "<cia|cia6526|cia8520|cia8521|via|pia> <trace>\n");
+        return 2;
+    }
+
+    const Personality* pers = nullptr;
+    for (const auto& p : personalities) {
+        if (std::strcmp(p.name, argv[optind]) == 0) {
+            pers = &p;
+        }
+    }
+    if (!pers || !pers->make) {
+        std::fprintf(stderr, "trace_replay: no model for %s\n", argv[optind]);
+        return 2;
+    }
+
+    // Compared pins, and released open drain IRQ lines.
+    PinWord compare = 0;
+    PinWord release = 0;
+    for (const auto& p : pers->pins) {
+        if (prefix(p.name, "IRQ")) {
+            release |= pin_mask(p.pin);
+        }
+        if (prefix(p.name, "DB") || prefix(p.name, "IRQ") ||
+            prefix(p.name, "PA") || prefix(p.name, "PB"))
+        {
+            compare |= pin_mask(p.pin);
+        }
+    }
+
+    int fd = open(argv[optind + 1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        std::perror(argv[optind + 1]);
+        return 1;
+    }
+    size_t n = st.st_size/sizeof(PinWord);
+    void* map = n ? mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+    if (map == MAP_FAILED) {
+        std::perror(argv[optind + 1]);
+        close(fd);
+        return 1;
+    }
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    const PinWord* trace = static_cast<const PinWord*>(map);
+
+    std::unique_ptr<Model> model = pers->make();
+
+    // Replay in chunks which fit in cache.
+    constexpr size_t chunk = 1 << 14;
+    std::vector<PinWord> in(chunk);
+    std::vector<PinWord> out(chunk);
+    std::chrono::duration<double> t(0);
+
+    for (size_t i = 0; i < n; i += chunk) {
+        size_t len = std::min(chunk, n - i);
+
+        for (size_t j = 0; j < len; j++) {
+            in[j] = trace[i + j] | release;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        model->load(in.data(), out.data(), len);
+        model->step(len);
+        t += std::chrono::steady_clock::now() - t0;
+
+        for (size_t j = 0; j < len; j++) {
+            if ((out[j] ^ trace[i + j]) & compare) {
+                if (mismatches++ < max) {
+                    report(*pers, i + j, compare, trace[i + j], out[j]);
+                }
+            }
+        }
+    }
+
+    if (map) {
+        munmap(map, st.st_size);
+    }
+
+    std::printf("%s: %llu cycles, %lld mismatches, %.2f M cycles/s\n",
+                pers->name, (unsigned long long)model->cycles(), mismatches,
+                t.count() > 0 ? model->cycles()/t.count()/1e6 : 0.0);
+
+    return mismatches != 0;
+}
@@ -0,0 +1,158 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#include "via_model.h"
+#include "via_pins.h"
+
+#include "Vvia.h"
+#include "verilated.h"
+
+#include <algorithm>
+
+using namespace via_pins;
+
+namespace {
+
+// Fields of the VIA core inputs.
+enum : unsigned {
+    I_DB  = 0,   // 8 bits
+    I_PA  = 8,   // 8 bits
+    I_PB  = 16,  // 8 bits
+    I_RS  = 24,  // 4 bits
+    I_RES = 28,
+    I_CS1 = 29,
+    I_CS2 = 30,
+    I_R_W = 31,
+    I_CA1 = 32,
+    I_CA2 = 33,
+    I_CB1 = 34,
+    I_CB2 = 35,
+};
+
+// Fields of the VIA core outputs.
+enum : unsigned {
+    O_DB  = 0,    // 8 bits
+    O_PA  = 8,    // 8 bits
+    O_PB  = 16,   // 8 bits
+    O_CA2 = 24,
+    O_CB1 = 25,
+    O_CB2 = 26,
+    O_IRQ = 27,
+};
+
+constexpr unsigned DB[8] = { DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7 };
+constexpr unsigned PA[8] = { PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7 };
+constexpr unsigned PB[8] = { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+
+struct PinMap {
+    PinGather gather;
+    PinScatter scatter;
+
+    PinMap()
+    {
+        for (unsigned i = 0; i < 8; i++) {
+            gather.map(DB[i], I_DB + i);
+            gather.map(PA[i], I_PA + i);
+            gather.map(PB[i], I_PB + i);
+            scatter.map(O_DB + i, DB[i]);
+            scatter.map(O_PA + i, PA[i]);
+            scatter.map(O_PB + i, PB[i]);
+        }
+        gather.map(RS0, I_RS + 0);
+        gather.map(RS1, I_RS + 1);
+        gather.map(RS2, I_RS + 2);
+        gather.map(RS3, I_RS + 3);
+        gather.map(RES, I_RES);
+        gather.map(CS1, I_CS1);
+        gather.map(CS2, I_CS2);
+        gather.map(R_W, I_R_W);
+        gather.map(CA1, I_CA1);
+        gather.map(CA2, I_CA2);
+        gather.map(CB1, I_CB1);
+        gather.map(CB2, I_CB2);
+        scatter.map(O_CA2, CA2);
+        scatter.map(O_CB1, CB1);
+        scatter.map(O_CB2, CB2);
+        scatter.map(O_IRQ, IRQ);
+    }
+};
+
+const PinMap pin_map;
+
+}  // namespace
+
+ViaModel::ViaModel() :
+    context(std::make_unique<VerilatedContext>()),
+    top(std::make_unique<Vvia>(context.get()))
+{
+    top->phi2 = 0;
+    top->res_n = 0;
+    top->cs1 = 0;
+    top->cs2_n = 1;
+    top->r_w = 1;
+    top->eval();
+}
+
+ViaModel::~ViaModel()
+{
+    top->final();
+}
+
+size_t ViaModel::step(size_t n)
+{
+    Vvia& m = *top;
+
+    n = std::min(n, len - pos);
+
+    const PinWord* p = in + pos;
+    PinWord* q = out + pos;
+
+    for (const PinWord* end = p + n; p != end; p++, q++) {
+        PinWord w = *p;
+        uint64_t f = pin_map.gather(w);
+
+        // Ports and control lines read back the resolved pin levels, see
+        // CiaModel::step().
+        unsigned pa = f >> I_PA & 0xFF;
+        unsigned pb = f >> I_PB & 0xFF;
+
+        m.res_n = f >> I_RES & 1;
+        m.cs1   = f >> I_CS1 & 1;
+        m.cs2_n = f >> I_CS2 & 1;
+        m.r_w   = f >> I_R_W & 1;
+        m.rs    = f >> I_RS & 0xF;
+        m.db_i  = f >> I_DB & 0xFF;
+        m.pa_i  = (pa & ~m.pa_oe) | (m.pa_o & m.pa_oe);
+        m.pb_i  = (pb & ~m.pb_oe) | (m.pb_o & m.pb_oe);
+        m.ca1   = f >> I_CA1 & 1;
+        m.ca2_i = m.ca2_oe ? m.ca2_o : f >> I_CA2 & 1;
+        m.cb1_i = m.cb1_oe ? m.cb1_o : f >> I_CB1 & 1;
+        m.cb2_i = m.cb2_oe ? m.cb2_o : f >> I_CB2 & 1;
+
+        // PHI2 high: control lines are sampled, and read data is driven.
+        m.phi2 = 1;
+        m.eval();
+
+        // Outputs are applied to the external pin levels. Port A and IRQ are
+        // open drain, port B and the control lines push-pull.
+        uint32_t o = m.db_o << O_DB | m.pa_o << O_PA | m.pb_o << O_PB |
+                     m.ca2_o << O_CA2 | m.cb1_o << O_CB1 | m.cb2_o << O_CB2;
+        uint32_t oe = (m.db_oe ? 0xFF << O_DB : 0) | m.pa_oe << O_PA |
+                      m.pb_oe << O_PB | m.ca2_oe << O_CA2 | m.cb1_oe << O_CB1 |
+                      m.cb2_oe << O_CB2 | !m.irq_n << O_IRQ;
+        *q = (w & ~pin_map.scatter(oe)) | pin_map.scatter(o & oe);
+
+        // PHI2 low: registers are updated.
+        m.phi2 = 0;
+        m.eval();
+    }
+
+    pos += n;
+    ncycles += n;
+
+    return n;
+}
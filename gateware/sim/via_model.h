@@ -0,0 +1,29 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "model.h"
+
+#include <memory>
+
+class VerilatedContext;
+class Vvia;
+
+// Model of the VIA core, built by Verilator. Pin names are as in
+// redip-via.pcf.
+class ViaModel : public Model {
+public:
+    ViaModel();
+    ~ViaModel() override;
+
+    size_t step(size_t n) override;
+
+private:
+    std::unique_ptr<VerilatedContext> context;
+    std::unique_ptr<Vvia> top;
+};
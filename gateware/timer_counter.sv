@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// 16 bit down counter with parallel load, shared by the CIA and VIA timers.
+//
+// The counter is updated on the falling edge of PHI2: load takes precedence
+// over count. zero is high when the counter is zero.
+//
+// With MAC16 = 1, the counter is the bottom accumulator of an SB_MAC16, which
+// adds 16'hFFFF to itself on count, and loads from D on load. The carry out
+// of this addition is low only for a zero counter; it is passed through the
+// top adder as O[16], so that neither a LUT based decrement nor a 16 bit zero
+// compare is needed. sim/cia_errata checks the CIA built with the yosys
+// SB_MAC16 model against the LUT counter.
+module timer_counter #(
+    parameter MAC16 = 0
+) (
+    input  logic        phi2,
+    input  logic        load,
+    input  logic [15:0] value,
+    input  logic        count,
+    output logic [15:0] counter,
+    output logic        zero
+);
+
+    generate
+        if (MAC16) begin : mac16
+            logic [31:0] o;
+
+            SB_MAC16 #(
+                .NEG_TRIGGER           (1'b1),
+                .TOPOUTPUT_SELECT      (2'b00),  // Unregistered top adder
+                .TOPADDSUB_LOWERINPUT  (2'b00),  // A
+                .TOPADDSUB_UPPERINPUT  (1'b1),   // C
+                .TOPADDSUB_CARRYSELECT (2'b11),  // Bottom adder carry out
+                .BOTOUTPUT_SELECT      (2'b01),  // Bottom accumulator
+                .BOTADDSUB_LOWERINPUT  (2'b00),  // B
+                .BOTADDSUB_UPPERINPUT  (1'b0),   // Accumulator
+                .BOTADDSUB_CARRYSELECT (2'b00)   // Constant 0
+            ) counter_mac (
+                .CLK       (phi2),
+                .CE        (1'b1),
+                .A         (16'h0000),
+                .B         (16'hFFFF),
+                .C         (16'h0000),
+                .D         (value),
+                .AHOLD     (1'b0),
+                .BHOLD     (1'b0),
+                .CHOLD     (1'b0),
+                .DHOLD     (1'b0),
+                .IRSTTOP   (1'b0),
+                .IRSTBOT   (1'b0),
+                .ORSTTOP   (1'b0),
+                .ORSTBOT   (1'b0),
+                .OLOADTOP  (1'b0),
+                .OLOADBOT  (load),
+                .ADDSUBTOP (1'b0),
+                .ADDSUBBOT (1'b0),
+                .OHOLDTOP  (1'b0),
+                .OHOLDBOT  (!(load || count)),
+                .CI        (1'b0),
+                .ACCUMCI   (1'b0),
+                .SIGNEXTIN (1'b0),
+                .O         (o)
+            );
+
+            assign counter = o[15:0];
+            assign zero    = !o[16];
+        end else begin : lut
+            always_ff @(negedge phi2) begin
+                if (load) begin
+                    counter <= value;
+                end else if (count) begin
+                    counter <= counter - 1'b1;
+                end
+            end
+
+            assign zero = counter == 16'h0000;
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+# ----------------------------------------------------------------------------
+# This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+# MOS 6526/8520/8521 CIA FPGA replacement.
+#
+# Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+# ----------------------------------------------------------------------------
+
+"""Summarize nextpnr --report JSON files.
+
+usage: timing_report.py <nextpnr-report.json>
+       timing_report.py --summary <image>-<freq>MHz-report.json...
+       timing_report.py --best <image>.asc <image>-<seed>-report.json...
+
+Prints clock Fmax, utilization, and the critical paths which end on the
+DB0 - DB7 pads. The path from PHI2 to DB0 - DB7 is combinational (PHI2 gates
+the output enable), and is reported by nextpnr as an <async> path.
+
+With --summary, prints one line per report from make timing: PHI2 Fmax, worst
+slack against the PHI2 constraint, the longest path to DB0 - DB7, and LUT / FF
+counts taken from the <image>.json netlist. Exits with status 1 if any clock
+of any report misses its own constraint, such as the internal oscillator
+clock of FLASH_UPDATE=1 or of an oscillator TIMER_CLOCK.
+
+With --best, prints the PHI2 Fmax and worst slack of each seed from make
+seeds, and copies the placement and report with the highest PHI2 Fmax among
+those which meet every clock constraint to <image>.asc and
+<image>-report.json. Exits with status 1 if that placement misses a
+constraint.
+"""
+
+import json
+import os
+import re
+import shutil
+import sys
+
+
+def cell_name(point):
+    return point.get("cell", "") if isinstance(point, dict) else str(point)
+
+
+def path_delay(path):
+    return sum(seg.get("delay", 0.0) for seg in path)
+
+
+def db_paths(report):
+    for cp in report.get("critical_paths", []):
+        path = cp.get("path", [])
+        if path and "DB" in cell_name(path[-1].get("to")):
+            yield cp, path
+
+
+def cell_counts(netlist):
+    """LUT and FF counts of the top module in a yosys JSON netlist."""
+    luts = ffs = 0
+    for module in netlist.get("modules", {}).values():
+        if not module.get("attributes", {}).get("top"):
+            continue
+        for cell in module.get("cells", {}).values():
+            if cell["type"] == "SB_LUT4":
+                luts += 1
+            elif cell["type"].startswith("SB_DFF"):
+                ffs += 1
+    return luts, ffs
+
+
+def is_phi2(clock):
+    return "phi2" in clock.lower()
+
+
+def fmax_of(report):
+    """Fmax and constraint of the PHI2 clock, in MHz.
+
+    Other clocks, such as the internal oscillator or CNT as the timer clock,
+    have constraints of their own, see failing_clocks().
+    """
+    clocks = [c for name, c in report.get("fmax", {}).items() if is_phi2(name)]
+    if not clocks:
+        raise ValueError("no PHI2 clock in report")
+    return min(c["achieved"] for c in clocks), max(c["constraint"] for c in clocks)
+
+
+def failing_clocks(report):
+    """Names of the clocks which miss their own constraint."""
+    return [name for name, c in report.get("fmax", {}).items()
+            if c["achieved"] < c["constraint"]]
+
+
+def best(asc, files):
+    print(f"{'image':12} {'seed':>5} {'Fmax':>8} {'slack ns':>9}")
+
+    results = []
+    for name in files:
+        m = re.match(r"(.*)-([0-9]+)-report\.json$", os.path.basename(name))
+        if not m:
+            print(f"{name}: not a make seeds report", file=sys.stderr)
+            return 2
+        with open(name) as f:
+            report = json.load(f)
+        try:
+            fmax, freq = fmax_of(report)
+        except ValueError as e:
+            print(f"{name}: {e}", file=sys.stderr)
+            return 2
+        failing = failing_clocks(report)
+        results.append((not failing, fmax, name))
+        print(f"{m.group(1):12} {m.group(2):>5} {fmax:8.2f} {1000 / freq - 1000 / fmax:9.2f}"
+              f"{'  FAIL: ' + ', '.join(failing) if failing else ''}")
+
+    # Placements which meet every clock constraint first, then by PHI2 Fmax.
+    ok, fmax, name = max(results)
+    print(f"best: {os.path.basename(name)}, copied to {asc}")
+    shutil.copyfile(name[:-len("-report.json")] + ".asc", asc)
+    shutil.copyfile(name, asc[:-len(".asc")] + "-report.json")
+
+    return 0 if ok else 1
+
+
+def summary(files):
+    print(f"{'image':12} {'MHz':>5} {'Fmax':>8} {'slack ns':>9} {'DB ns':>7} "
+          f"{'LUT':>5} {'FF':>5}  result")
+
+    failed = False
+    for name in files:
+        m = re.match(r"(.*)-([0-9.]+)MHz-report\.json$", os.path.basename(name))
+        if not m:
+            print(f"{name}: not a make timing report", file=sys.stderr)
+            return 2
+        image, freq = m.group(1), float(m.group(2))
+
+        with open(name) as f:
+            report = json.load(f)
+        with open(os.path.join(os.path.dirname(name), os.pardir, image + ".json")) as f:
+            luts, ffs = cell_counts(json.load(f))
+
+        try:
+            fmax, _ = fmax_of(report)
+        except ValueError as e:
+            print(f"{name}: {e}", file=sys.stderr)
+            return 2
+        slack = 1000 / freq - 1000 / fmax
+        db = max((path_delay(p) for _, p in db_paths(report)), default=0.0)
+
+        failing = failing_clocks(report)
+        failed |= bool(failing)
+        print(f"{image:12} {freq:5g} {fmax:8.2f} {slack:9.2f} {db:7.2f} "
+              f"{luts:5} {ffs:5}  {'FAIL: ' + ', '.join(failing) if failing else 'ok'}")
+
+    return 1 if failed else 0
+
+
+def main(argv):
+    if len(argv) > 2 and argv[1] == "--summary":
+        return summary(argv[2:])
+    if len(argv) > 3 and argv[1] == "--best":
+        return best(argv[2], argv[3:])
+
+    if len(argv) != 2:
+        print(__doc__.split("\n\n")[1], file=sys.stderr)
+        return 2
+
+    with open(argv[1]) as f:
+        report = json.load(f)
+
+    print("Fmax:")
+    for clk, fmax in report.get("fmax", {}).items():
+        print(f"  {clk}: {fmax['achieved']:.2f} MHz (constraint {fmax['constraint']:.2f} MHz)")
+
+    print("Utilization:")
+    for bel, util in report.get("utilization", {}).items():
+        if util["used"]:
+            print(f"  {bel}: {util['used']}/{util['available']}")
+
+    print("Paths to DB0 - DB7:")
+    found = False
+    for cp, path in db_paths(report):
+        start = cell_name(path[0].get("from"))
+        end = cell_name(path[-1].get("to"))
+        found = True
+        print(f"  {cp['from']} -> {cp['to']}: {start} -> {end}, {path_delay(path):.2f} ns")
+        for seg in path:
+            print(f"    {seg['type']:9} {seg.get('delay', 0.0):6.2f} ns  "
+                  f"{cell_name(seg.get('from'))} -> {cell_name(seg.get('to'))}")
+    if not found:
+        print("  none reported")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,361 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6522 Versatile Interface Adapter.
+//
+// As for the CIA, PHI2 is used directly as the clock, all state is updated on
+// the falling edge of PHI2, and read data is a combinational function of
+// RS0 - RS3 driven while PHI2 is high.
+//
+// CA1, CA2, CB1, CB2 and PB6 are sampled on the rising edge of PHI2, and
+// edges are acted on at the following falling edge. IRQ is a combinational
+// function of IFR and IER, so an active CA1 transition sets IFR and pulls IRQ
+// low at the first falling edge of PHI2 which is at least half a cycle after
+// it, i.e. 0.5 - 1.5 cycles after the transition. The half cycle between
+// the sampling and use of the control lines gives synchronizer settling time.
+//
+// Port A is open drain like the NMOS 6522 passive pull-up outputs, with the
+// 4.7k pull-ups on the board providing the high level. Port B, CA2, CB1 and
+// CB2 are push-pull when outputs. IRQ is open drain.
+//
+// TIMER_MAC16: implement the Timer 1 and Timer 2 counters in SB_MAC16 blocks,
+// see timer_counter.sv.
+module via #(
+    parameter TIMER_MAC16 = 0
+) (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic       cs1,
+    input  logic       cs2_n,
+    input  logic       r_w,
+    input  logic [3:0] rs,
+    input  logic [7:0] db_i,
+    output logic [7:0] db_o,
+    output logic       db_oe,
+    input  logic [7:0] pa_i,
+    output logic [7:0] pa_o,
+    output logic [7:0] pa_oe,
+    input  logic [7:0] pb_i,
+    output logic [7:0] pb_o,
+    output logic [7:0] pb_oe,
+    input  logic       ca1,
+    input  logic       ca2_i,
+    output logic       ca2_o,
+    output logic       ca2_oe,
+    input  logic       cb1_i,
+    output logic       cb1_o,
+    output logic       cb1_oe,
+    input  logic       cb2_i,
+    output logic       cb2_o,
+    output logic       cb2_oe,
+    output logic       irq_n,
+    output logic [1:0] timer_event
+);
+
+    // Register addresses.
+    localparam ORB  = 4'h0;
+    localparam ORA  = 4'h1;
+    localparam DDRB = 4'h2;
+    localparam DDRA = 4'h3;
+    localparam T1CL = 4'h4;
+    localparam T1CH = 4'h5;
+    localparam T1LL = 4'h6;
+    localparam T1LH = 4'h7;
+    localparam T2CL = 4'h8;
+    localparam T2CH = 4'h9;
+    localparam SR   = 4'hA;
+    localparam ACR  = 4'hB;
+    localparam PCR  = 4'hC;
+    localparam IFR  = 4'hD;
+    localparam IER  = 4'hE;
+    localparam ORAN = 4'hF;
+
+    // Interrupt flag bits.
+    localparam CA2_IRQ = 0;
+    localparam CA1_IRQ = 1;
+    localparam SR_IRQ  = 2;
+    localparam CB2_IRQ = 3;
+    localparam CB1_IRQ = 4;
+    localparam T2_IRQ  = 5;
+    localparam T1_IRQ  = 6;
+
+    // Bus interface.
+    logic [7:0]  rdata;
+    logic [15:0] rd_reg;
+    logic [15:0] wr_reg;
+
+    bus_io #(
+        .REGS      (16),
+        .CS_WIDTH  (2),
+        .CS_ACTIVE (2'b01)
+    ) bus (
+        .phi2  (phi2),
+        .cs    ({ cs2_n, cs1 }),
+        .r_w   (r_w),
+        .rs    (rs),
+        .rdata (rdata),
+        .db_o  (db_o),
+        .db_oe (db_oe),
+        .rd    (rd_reg),
+        .wr    (wr_reg)
+    );
+
+    // Port and control registers.
+    logic [7:0] ora;
+    logic [7:0] orb;
+    logic [7:0] ddra;
+    logic [7:0] ddrb;
+    logic [7:0] acr;
+    logic [7:0] pcr;
+    logic [7:0] pa_latch;
+    logic [7:0] pb_latch;
+
+    // Interrupt control.
+    logic [6:0] ifr;
+    logic [6:0] ier;
+
+    // Control lines, sampled on the rising edge of PHI2, and the values seen
+    // at the previous falling edge.
+    logic ca1_s, ca2_s, cb1_s, cb2_s, pb6_s;
+    logic ca1_q, ca2_q, cb1_q, cb2_q, pb6_q;
+
+    always_ff @(posedge phi2) begin
+        ca1_s <= ca1;
+        ca2_s <= ca2_i;
+        cb1_s <= cb1_i;
+        cb2_s <= cb2_i;
+        pb6_s <= pb_i[6];
+    end
+
+    wire ca1_edge = pcr[0] ? ca1_s && !ca1_q : !ca1_s && ca1_q;
+    wire ca2_edge = pcr[2] ? ca2_s && !ca2_q : !ca2_s && ca2_q;
+    wire cb1_edge = pcr[4] ? cb1_s && !cb1_q : !cb1_s && cb1_q;
+    wire cb2_edge = pcr[6] ? cb2_s && !cb2_q : !cb2_s && cb2_q;
+
+    wire ca2_input = !pcr[3];
+    wire cb2_input = !pcr[7];
+
+    // Timers.
+    logic [15:0] t1;
+    logic [15:0] t1_latch;
+    logic        t1_timeout;
+    logic        t1_pb7;
+    logic [15:0] t2;
+    logic        t2_timeout;
+    logic        t2_tick;
+
+    via_t1 #(
+        .MAC16 (TIMER_MAC16)
+    ) timer1 (
+        .phi2    (phi2),
+        .res_n   (res_n),
+        .wr_ll   (wr_reg[T1CL] || wr_reg[T1LL]),
+        .wr_lh   (wr_reg[T1LH]),
+        .wr_ch   (wr_reg[T1CH]),
+        .data    (db_i),
+        .freerun (acr[6]),
+        .counter (t1),
+        .latch   (t1_latch),
+        .timeout (t1_timeout),
+        .pb7     (t1_pb7)
+    );
+
+    via_t2 #(
+        .MAC16 (TIMER_MAC16)
+    ) timer2 (
+        .phi2       (phi2),
+        .res_n      (res_n),
+        .wr_ll      (wr_reg[T2CL]),
+        .wr_ch      (wr_reg[T2CH]),
+        .data       (db_i),
+        .pulse_mode (acr[5]),
+        .pb6_fall   (!pb6_s && pb6_q),
+        .sr_t2      (acr[4:2] == 3'b001 || acr[4:2] == 3'b100 || acr[4:2] == 3'b101),
+        .counter    (t2),
+        .timeout    (t2_timeout),
+        .tick       (t2_tick)
+    );
+
+    // Shift register.
+    logic [7:0] sr;
+    logic       sr_irq;
+    logic       sr_cb1_o;
+    logic       sr_cb1_oe;
+    logic       sr_cb2_o;
+    logic       sr_cb2_oe;
+
+    via_sr shift (
+        .phi2     (phi2),
+        .res_n    (res_n),
+        .mode     (acr[4:2]),
+        .start    (rd_reg[SR] || wr_reg[SR]),
+        .wr       (wr_reg[SR]),
+        .data     (db_i),
+        .t2_tick  (t2_tick),
+        .cb1_rise (cb1_s && !cb1_q),
+        .cb1_fall (!cb1_s && cb1_q),
+        .cb2_i    (cb2_s),
+        .sr       (sr),
+        .cb1_o    (sr_cb1_o),
+        .cb1_oe   (sr_cb1_oe),
+        .cb2_o    (sr_cb2_o),
+        .cb2_oe   (sr_cb2_oe),
+        .irq      (sr_irq)
+    );
+
+    // CA2 and CB2 outputs: handshake, pulse, low or high.
+    logic ca2_hs;
+    logic cb2_hs;
+
+    assign ca2_o  = pcr[2] ? pcr[1] : ca2_hs;
+    assign ca2_oe = !ca2_input;
+
+    assign cb1_o  = sr_cb1_o;
+    assign cb1_oe = sr_cb1_oe;
+    assign cb2_o  = sr_cb2_oe ? sr_cb2_o : pcr[6] ? pcr[5] : cb2_hs;
+    assign cb2_oe = sr_cb2_oe || !cb2_input;
+
+    // Ports. PB7 is the Timer 1 output when enabled.
+    logic [7:0] pb_out;
+    logic [7:0] pb_dir;
+
+    always_comb begin
+        pb_out = orb;
+        pb_dir = ddrb;
+        if (acr[7]) begin
+            pb_out[7] = t1_pb7;
+            pb_dir[7] = 1'b1;
+        end
+    end
+
+    assign pa_o  = ora;
+    assign pa_oe = ddra & ~ora;
+    assign pb_o  = pb_out;
+    assign pb_oe = pb_dir;
+
+    // Read data. IRB reads output bits from the output register, and input
+    // bits from the pins or, with latching enabled, from the input latch.
+    wire [7:0] ira = acr[0] ? pa_latch : pa_i;
+    wire [7:0] irb = (pb_dir & pb_out) | (~pb_dir & (acr[1] ? pb_latch : pb_i));
+    wire       irq = |(ifr & ier);
+
+    always_comb begin
+        case (rs)
+            ORB:  rdata = irb;
+            ORA:  rdata = ira;
+            DDRB: rdata = ddrb;
+            DDRA: rdata = ddra;
+            T1CL: rdata = t1[7:0];
+            T1CH: rdata = t1[15:8];
+            T1LL: rdata = t1_latch[7:0];
+            T1LH: rdata = t1_latch[15:8];
+            T2CL: rdata = t2[7:0];
+            T2CH: rdata = t2[15:8];
+            SR:   rdata = sr;
+            ACR:  rdata = acr;
+            PCR:  rdata = pcr;
+            IFR:  rdata = { irq, ifr };
+            IER:  rdata = { 1'b1, ier };
+            ORAN: rdata = ira;
+        endcase
+    end
+
+    assign irq_n = !irq;
+
+    // Timer time-out strobes, for instrumentation, see redip_perf.sv.
+    assign timer_event = { t2_timeout, t1_timeout };
+
+    // Interrupt flag clearing by register accesses.
+    wire ora_access = rd_reg[ORA] || wr_reg[ORA];
+    wire orb_access = rd_reg[ORB] || wr_reg[ORB];
+
+    logic [6:0] ifr_clear;
+    logic [6:0] ifr_set;
+
+    always_comb begin
+        ifr_clear = wr_reg[IFR] ? db_i[6:0] : 7'h00;
+        if (ora_access) begin
+            ifr_clear[CA1_IRQ] = 1'b1;
+            if (!(ca2_input && pcr[1])) ifr_clear[CA2_IRQ] = 1'b1;
+        end
+        if (orb_access) begin
+            ifr_clear[CB1_IRQ] = 1'b1;
+            if (!(cb2_input && pcr[5])) ifr_clear[CB2_IRQ] = 1'b1;
+        end
+        if (rd_reg[SR] || wr_reg[SR]) ifr_clear[SR_IRQ] = 1'b1;
+        if (rd_reg[T1CL] || wr_reg[T1CH] || wr_reg[T1LH]) ifr_clear[T1_IRQ] = 1'b1;
+        if (rd_reg[T2CL] || wr_reg[T2CH]) ifr_clear[T2_IRQ] = 1'b1;
+
+        ifr_set = 7'h00;
+        ifr_set[CA2_IRQ] = ca2_input && ca2_edge;
+        ifr_set[CA1_IRQ] = ca1_edge;
+        ifr_set[SR_IRQ]  = sr_irq;
+        ifr_set[CB2_IRQ] = cb2_input && cb2_edge;
+        ifr_set[CB1_IRQ] = cb1_edge;
+        ifr_set[T2_IRQ]  = t2_timeout;
+        ifr_set[T1_IRQ]  = t1_timeout;
+    end
+
+    always_ff @(negedge phi2) begin
+        ca1_q <= ca1_s;
+        ca2_q <= ca2_s;
+        cb1_q <= cb1_s;
+        cb2_q <= cb2_s;
+        pb6_q <= pb6_s;
+
+        if (!res_n) begin
+            ora    <= 8'h00;
+            orb    <= 8'h00;
+            ddra   <= 8'h00;
+            ddrb   <= 8'h00;
+            acr    <= 8'h00;
+            pcr    <= 8'h00;
+            ifr    <= 7'h00;
+            ier    <= 7'h00;
+            ca2_hs <= 1'b1;
+            cb2_hs <= 1'b1;
+        end else begin
+            if (wr_reg[ORA] || wr_reg[ORAN]) ora <= db_i;
+            if (wr_reg[ORB])  orb  <= db_i;
+            if (wr_reg[DDRA]) ddra <= db_i;
+            if (wr_reg[DDRB]) ddrb <= db_i;
+            if (wr_reg[ACR])  acr  <= db_i;
+            if (wr_reg[PCR])  pcr  <= db_i;
+
+            if (wr_reg[IER]) begin
+                ier <= db_i[7] ? ier | db_i[6:0] : ier & ~db_i[6:0];
+            end
+
+            // Interrupt sources in the cycle of a clearing access are not
+            // lost.
+            ifr <= (ifr & ~ifr_clear) | ifr_set;
+
+            // Input latches.
+            if (ca1_edge) pa_latch <= pa_i;
+            if (cb1_edge) pb_latch <= pb_i;
+
+            // Handshake (PCR x2 x1 = 00) and pulse (01) outputs. CA2 goes low
+            // on a read or write of ORA, CB2 on a write of ORB. Handshake
+            // outputs return high on the active CA1 / CB1 edge, pulses after
+            // one cycle.
+            if (ora_access) begin
+                ca2_hs <= 1'b0;
+            end else if (pcr[1] || ca1_edge) begin
+                ca2_hs <= 1'b1;
+            end
+
+            if (wr_reg[ORB]) begin
+                cb2_hs <= 1'b0;
+            end else if (pcr[5] || cb1_edge) begin
+                cb2_hs <= 1'b1;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,147 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6522 shift register.
+//
+// The mode is given by ACR bits 4 - 2:
+//
+//   000: disabled
+//   001: shift in, Timer 2 rate         101: shift out, Timer 2 rate
+//   010: shift in, PHI2 rate            110: shift out, PHI2 rate
+//   011: shift in, external CB1         111: shift out, external CB1
+//   100: shift out free-running, Timer 2 rate
+//
+// A read or write of the shift register starts eight bits. CB1 is the shift
+// clock, and is an output except in the external modes; CB2 is the data
+// input or output. Data is shifted MSB first, and shifted in on rising CB1
+// edges. Output data changes on falling CB1 edges, and is rotated back into
+// bit 0, so that the free-running mode repeats the same byte.
+//
+// At the Timer 2 rate, CB1 toggles on each Timer 2 tick. At the PHI2 rate,
+// one bit is shifted per PHI2 cycle, with CB1 pulsing low while PHI2 is low.
+module via_sr (
+    input  logic       phi2,
+    input  logic       res_n,
+    input  logic [2:0] mode,
+    input  logic       start,     // Shift register read or write
+    input  logic       wr,
+    input  logic [7:0] data,
+    input  logic       t2_tick,
+    input  logic       cb1_rise,
+    input  logic       cb1_fall,
+    input  logic       cb2_i,
+    output logic [7:0] sr,
+    output logic       cb1_o,
+    output logic       cb1_oe,
+    output logic       cb2_o,
+    output logic       cb2_oe,
+    output logic       irq
+);
+
+    logic [2:0] bitcnt;
+    logic       active;
+    logic       clk_q;
+    logic       pulse_q;
+
+    wire shift_out = mode[2];
+    wire t2_rate   = mode == 3'b001 || mode == 3'b100 || mode == 3'b101;
+    wire phi2_rate = mode[1:0] == 2'b10;
+    wire ext_clock = mode[1:0] == 2'b11;
+
+    // Shift clock edges at the Timer 2 rate and in the external modes.
+    logic fall;
+    logic rise;
+
+    always_comb begin
+        if (t2_rate) begin
+            fall = active && t2_tick && clk_q;
+            rise = active && t2_tick && !clk_q;
+        end else begin
+            fall = active && ext_clock && cb1_fall;
+            rise = active && ext_clock && cb1_rise;
+        end
+    end
+
+    assign cb1_oe = mode != 3'b000 && !ext_clock;
+    assign cb1_o  = phi2_rate ? !(pulse_q && !phi2) : clk_q;
+    assign cb2_oe = shift_out;
+
+    always_ff @(negedge phi2) begin
+        if (!res_n) begin
+            bitcnt  <= 3'd0;
+            active  <= 1'b0;
+            clk_q   <= 1'b1;
+            pulse_q <= 1'b0;
+            cb2_o   <= 1'b1;
+            irq     <= 1'b0;
+        end else begin
+            irq <= 1'b0;
+
+            if (phi2_rate && shift_out) begin
+                // Each bit is presented on a falling edge of PHI2, with a CB1
+                // pulse in the following PHI2 low phase.
+                if (active) begin
+                    cb2_o   <= sr[7];
+                    sr      <= { sr[6:0], sr[7] };
+                    bitcnt  <= bitcnt + 3'd1;
+                    pulse_q <= 1'b1;
+                    if (bitcnt == 3'd7) active <= 1'b0;
+                end else begin
+                    pulse_q <= 1'b0;
+                end
+                irq <= pulse_q && !active;
+            end else if (phi2_rate) begin
+                // Each bit is shifted in on the falling edge of PHI2 which
+                // follows a CB1 pulse, i.e. as sampled on the rising edge.
+                if (pulse_q) begin
+                    sr     <= { sr[6:0], cb2_i };
+                    bitcnt <= bitcnt + 3'd1;
+                    if (bitcnt == 3'd7) begin
+                        pulse_q <= 1'b0;
+                        active  <= 1'b0;
+                        irq     <= 1'b1;
+                    end
+                end
+            end else begin
+                pulse_q <= 1'b0;
+
+                if (t2_rate && active && t2_tick) begin
+                    clk_q <= !clk_q;
+                end
+
+                if (fall && shift_out) begin
+                    cb2_o <= sr[7];
+                end
+
+                if (rise) begin
+                    sr     <= { sr[6:0], shift_out ? sr[7] : cb2_i };
+                    bitcnt <= bitcnt + 3'd1;
+                    if (bitcnt == 3'd7 && mode != 3'b100) begin
+                        active <= 1'b0;
+                        irq    <= 1'b1;
+                    end
+                end
+            end
+
+            if (mode == 3'b000) begin
+                active <= 1'b0;
+            end
+
+            if (start) begin
+                active  <= mode != 3'b000;
+                bitcnt  <= 3'd0;
+                clk_q   <= 1'b1;
+                pulse_q <= phi2_rate && !shift_out;
+            end
+        end
+
+        if (wr) sr <= data;
+    end
+
+endmodule
@@ -0,0 +1,78 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6522 Timer 1.
+//
+// The counter decrements on every falling edge of PHI2. Writing T1C-H
+// transfers the latch to the counter; after counting down to zero, the
+// counter reads FFFF for one cycle and is then reloaded from the latch, for a
+// period of N + 2 cycles. The reload happens in both one-shot and free-running
+// mode, but in one-shot mode only the first time-out after writing T1C-H
+// raises the interrupt.
+//
+// The PB7 output goes low on a write to T1C-H, and goes high (one-shot) or
+// inverts (free-running) on the same falling edge of PHI2 as the interrupt
+// flag is set, i.e. as the counter changes from 0 to FFFF.
+//
+// MAC16: implement the counter in an SB_MAC16, see timer_counter.sv.
+module via_t1 #(
+    parameter MAC16 = 0
+) (
+    input  logic        phi2,
+    input  logic        res_n,
+    input  logic        wr_ll,      // T1L-L / T1C-L write
+    input  logic        wr_lh,      // T1L-H write
+    input  logic        wr_ch,      // T1C-H write
+    input  logic [7:0]  data,
+    input  logic        freerun,    // ACR bit 6
+    output logic [15:0] counter,
+    output logic [15:0] latch,
+    output logic        timeout,
+    output logic        pb7
+);
+
+    logic armed;
+    logic reload_q;
+    logic zero;
+
+    wire [15:0] latch_next = { (wr_ch || wr_lh) ? data : latch[15:8],
+                               wr_ll ? data : latch[7:0] };
+
+    timer_counter #(
+        .MAC16 (MAC16)
+    ) timer (
+        .phi2    (phi2),
+        .load    (wr_ch || reload_q),
+        .value   (latch_next),
+        .count   (1'b1),
+        .counter (counter),
+        .zero    (zero)
+    );
+
+    // Interrupt on the change from 0 to FFFF.
+    wire underflow = zero && !wr_ch;
+    assign timeout = underflow && (freerun || armed);
+
+    always_ff @(negedge phi2) begin
+        latch    <= latch_next;
+        reload_q <= underflow;
+
+        if (!res_n) begin
+            armed <= 1'b0;
+            pb7   <= 1'b1;
+        end else if (wr_ch) begin
+            armed <= 1'b1;
+            pb7   <= 1'b0;
+        end else if (timeout) begin
+            armed <= 1'b0;
+            pb7   <= freerun ? !pb7 : 1'b1;
+        end
+    end
+
+endmodule
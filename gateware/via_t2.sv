@@ -0,0 +1,77 @@
+// ----------------------------------------------------------------------------
+// This file is part of reDIP CIA, a MOS 6520 PIA / MOS 6522 VIA /
+// MOS 6526/8520/8521 CIA FPGA replacement.
+//
+// Licensed under CERN-OHL-S v2 (https://ohwr.org/cern_ohl_s_v2.txt).
+// ----------------------------------------------------------------------------
+
+`default_nettype none
+
+// MOS 6522 Timer 2.
+//
+// Writing T2C-H transfers the low order latch and the written byte to the
+// counter, and arms the one-shot interrupt. The counter decrements on every
+// falling edge of PHI2 (ACR bit 5 = 0), raising the interrupt as it changes
+// from 0 to FFFF, or on falling edges of PB6 (ACR bit 5 = 1), raising the
+// interrupt as it reaches zero. It is not reloaded, and keeps counting after
+// the interrupt.
+//
+// While the shift register runs at the Timer 2 rate (sr_t2), the low order
+// counter is reloaded from the low order latch after reaching zero instead,
+// and holds for one cycle, for a shift clock period of N + 2 cycles per
+// half bit. tick marks each reload.
+//
+// MAC16: implement the counter in an SB_MAC16, see timer_counter.sv.
+module via_t2 #(
+    parameter MAC16 = 0
+) (
+    input  logic        phi2,
+    input  logic        res_n,
+    input  logic        wr_ll,      // T2L-L write
+    input  logic        wr_ch,      // T2C-H write
+    input  logic [7:0]  data,
+    input  logic        pulse_mode, // ACR bit 5
+    input  logic        pb6_fall,
+    input  logic        sr_t2,
+    output logic [15:0] counter,
+    output logic        timeout,
+    output logic        tick
+);
+
+    logic [7:0] latch;
+    logic       armed;
+    logic       hold;
+    logic       zero;
+
+    wire count = pulse_mode ? pb6_fall : !(sr_t2 && hold);
+
+    assign tick = sr_t2 && !hold && counter[7:0] == 8'h00 && !wr_ch;
+
+    timer_counter #(
+        .MAC16 (MAC16)
+    ) timer (
+        .phi2    (phi2),
+        .load    (wr_ch || tick),
+        .value   (wr_ch ? { data, latch } : { counter[15:8], latch }),
+        .count   (count),
+        .counter (counter),
+        .zero    (zero)
+    );
+
+    assign timeout = armed && !wr_ch && count && !tick &&
+                     (pulse_mode ? counter == 16'h0001 : zero);
+
+    always_ff @(negedge phi2) begin
+        if (wr_ll) latch <= data;
+        hold <= tick;
+
+        if (!res_n) begin
+            armed <= 1'b0;
+        end else if (wr_ch) begin
+            armed <= 1'b1;
+        end else if (timeout) begin
+            armed <= 1'b0;
+        end
+    end
+
+endmodule